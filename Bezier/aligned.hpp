@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/**
+ * Allocator returning ALIGN bytes aligned blocks, so that std::vector storage can be read with aligned SIMD loads.
+ * The block is over-allocated with operator new and the original pointer is kept just before the aligned address.
+ */
+template<class T, std::size_t ALIGN>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    template<class U>
+    struct rebind {
+        typedef AlignedAllocator<U, ALIGN> other;
+    };
+
+    AlignedAllocator() = default;
+
+    template<class U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGN> &) {}
+
+    T *allocate(std::size_t n) {
+        char *raw = static_cast<char *>(::operator new(n * sizeof(T) + ALIGN + sizeof(void *)));
+        std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw + sizeof(void *));
+        char *aligned = raw + sizeof(void *) + (ALIGN - first % ALIGN) % ALIGN;
+        reinterpret_cast<void **>(aligned)[-1] = raw;
+        return reinterpret_cast<T *>(aligned);
+    }
+
+    void deallocate(T *p, std::size_t) {
+        if (p)
+            ::operator delete(reinterpret_cast<void **>(p)[-1]);
+    }
+};
+
+template<class T, class U, std::size_t ALIGN>
+bool operator==(const AlignedAllocator<T, ALIGN> &, const AlignedAllocator<U, ALIGN> &) { return true; }
+
+template<class T, class U, std::size_t ALIGN>
+bool operator!=(const AlignedAllocator<T, ALIGN> &, const AlignedAllocator<U, ALIGN> &) { return false; }
+
+//Floats on 32 bytes boundaries, one AVX register
+typedef std::vector<float, AlignedAllocator<float, 32>> AlignedFloats;
@@ -0,0 +1,150 @@
+#include "arcLength.hpp"
+#include "curveBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //Gauss-Legendre nodes and weights on [-1, 1]
+    const double GL_NODES[5] = {-0.9061798459386640, -0.5384693101056831, 0., 0.5384693101056831,
+                                0.9061798459386640};
+    const double GL_WEIGHTS[5] = {0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665,
+                                  0.2369268850561891};
+}
+
+/**
+ * Constructor, builds the table
+ * @param ctrl Control points of the curve
+ * @param nbSpans Number of spans, 0 to pick it from the degree
+ */
+ArcLengthTable::ArcLengthTable(const std::vector<Point> &ctrl, const unsigned &nbSpans) {
+    build(ctrl, nbSpans);
+}
+
+/**
+ * Rebuild the table for new control points
+ * @param ctrl Control points of the curve
+ * @param nbSpans Number of spans, 0 to pick it from the degree (16 per degree, at least 16)
+ */
+void ArcLengthTable::build(const std::vector<Point> &ctrl, const unsigned &nbSpans) {
+    hodograph.clear();
+    lengths.clear();
+    bins.clear();
+    if (ctrl.size() < 2)
+        return;
+
+    unsigned degree = ctrl.size() - 1;
+    float d = float(degree);
+    for (unsigned i = 0; i < degree; ++i)
+        hodograph.push_back(Point((ctrl[i + 1] - ctrl[i]) * d));
+    if (basis.getDegree() != degree - 1)
+        basis = BernsteinBasis(degree - 1);
+
+    unsigned n = nbSpans ? nbSpans : std::max(16u, 16 * degree);
+
+    //Speeds at the Gauss-Legendre nodes of every span, batched while CurveBatch::Analytical is accurate
+    std::vector<float> params(5 * n);
+    for (unsigned k = 0; k < n; ++k) {
+        double half = 0.5 / n, mid = (k + 0.5) / n;
+        for (unsigned i = 0; i < 5; ++i)
+            params[5 * k + i] = float(mid + half * GL_NODES[i]);
+    }
+    std::vector<float> speeds(params.size());
+    if (hodograph.size() <= 16) {
+        std::vector<vec3> velocities;
+        CurveBatch(hodograph).Analytical(params, velocities);
+        for (unsigned k = 0; k < params.size(); ++k)
+            speeds[k] = ::length(Vector(velocities[k]));
+    } else {
+        for (unsigned k = 0; k < params.size(); ++k)
+            speeds[k] = speed(params[k]);
+    }
+
+    lengths.resize(n + 1);
+    double total = 0;
+    lengths[0] = 0;
+    for (unsigned k = 0; k < n; ++k) {
+        double sum = 0;
+        for (unsigned i = 0; i < 5; ++i)
+            sum += GL_WEIGHTS[i] * speeds[5 * k + i];
+        total += sum * 0.5 / n;
+        lengths[k + 1] = (float) total;
+    }
+
+    bins.resize(n);
+    unsigned k = 0;
+    for (unsigned b = 0; b < n; ++b) {
+        float target = lengths[n] * b / n;
+        while (k + 1 < n && lengths[k + 1] <= target)
+            ++k;
+        bins[b] = k;
+    }
+}
+
+/**
+ * Length of the curve between u0 and u1, one Gauss-Legendre rule
+ * @param u0
+ * @param u1
+ * @return
+ */
+double ArcLengthTable::integrate(const float &u0, const float &u1) const {
+    double half = 0.5 * (u1 - u0), mid = 0.5 * (u0 + u1);
+    double sum = 0;
+    for (unsigned i = 0; i < 5; ++i)
+        sum += GL_WEIGHTS[i] * speed(float(mid + half * GL_NODES[i]));
+    return sum * half;
+}
+
+/**
+ * @param u
+ * @return |C'(u)|
+ */
+float ArcLengthTable::speed(const float &u) const {
+    if (hodograph.empty())
+        return 0.f;
+    return ::length(Vector(basis.Analytical(hodograph.data(), u)));
+}
+
+/**
+ * @param u
+ * @return the length of the curve from 0 to u
+ */
+float ArcLengthTable::lengthAt(const float &u) const {
+    unsigned n = nbSpans();
+    if (n == 0 || u <= 0)
+        return 0.f;
+    if (u >= 1)
+        return length();
+    unsigned k = std::min(unsigned(u * n), n - 1);
+    return lengths[k] + (float) integrate(float(k) / n, u);
+}
+
+/**
+ * Inverse of lengthAt
+ * @param s Length along the curve, clamped to [0, length()]
+ * @return the parameter u such that the length from 0 to u is s
+ */
+float ArcLengthTable::param(const float &s) const {
+    unsigned n = nbSpans();
+    float total = length();
+    if (n == 0 || total <= 0 || s <= 0)
+        return 0.f;
+    if (s >= total)
+        return 1.f;
+
+    //First span k with lengths[k + 1] >= s, between the spans of bins b and b + 1 : binary search, the bin of an
+    //uneven parameterization may cover many spans
+    unsigned b = std::min(unsigned(s / total * n), n - 1);
+    unsigned first = bins[b], last = b + 1 < n ? std::min(bins[b + 1] + 1, n - 1) : n - 1;
+    unsigned k = unsigned(std::lower_bound(lengths.begin() + first + 1, lengths.begin() + last + 1, s) -
+                          lengths.begin()) - 1;
+
+    float u0 = float(k) / n, u1 = float(k + 1) / n;
+    float spanLength = lengths[k + 1] - lengths[k];
+    float u = spanLength > 0 ? u0 + (u1 - u0) * (s - lengths[k]) / spanLength : u0;
+
+    //Newton step on lengthAt(u) - s, the derivative of the length is the speed
+    float sp = speed(u);
+    if (sp > 0)
+        u -= (lengths[k] + (float) integrate(u0, u) - s) / sp;
+    return std::min(std::max(u, u0), u1);
+}
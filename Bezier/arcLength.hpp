@@ -0,0 +1,44 @@
+#pragma once
+
+#include "vec.h"
+#include "bernstein.hpp"
+#include <vector>
+
+/**
+ * Cumulative arc length of a Bezier curve, sampled at the ends of spans uniform in u. Each span is integrated
+ * with a 5 points Gauss-Legendre rule on the speed |C'(u)|, evaluated on the hodograph.
+ * The inverse u(s) locates the span through a table of uniform length bins (one bin per span) and a binary search
+ * among the spans of the bin, one or two on near uniform parameterizations and log2 of the spans at worst.
+ * It interpolates linearly inside the span and refines with one Newton step.
+ */
+class ArcLengthTable {
+private:
+    //Control points of C', degree times the control polygon edges
+    std::vector<Point> hodograph;
+    BernsteinBasis basis;
+
+    //lengths[k] is the length from u = 0 to u = k / nbSpans
+    std::vector<float> lengths;
+
+    //bins[b] is the span containing the length b * length() / nbSpans
+    std::vector<unsigned> bins;
+
+    double integrate(const float &u0, const float &u1) const;
+
+public:
+    ArcLengthTable() = default;
+
+    explicit ArcLengthTable(const std::vector<Point> &ctrl, const unsigned &nbSpans = 0);
+
+    void build(const std::vector<Point> &ctrl, const unsigned &nbSpans = 0);
+
+    unsigned nbSpans() const { return lengths.empty() ? 0 : (unsigned) lengths.size() - 1; }
+
+    float length() const { return lengths.empty() ? 0.f : lengths.back(); }
+
+    float speed(const float &u) const;
+
+    float lengthAt(const float &u) const;
+
+    float param(const float &s) const;
+};
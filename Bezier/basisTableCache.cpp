@@ -0,0 +1,151 @@
+#include "basisTableCache.hpp"
+#include "bernstein.hpp"
+#include "curveBatch.hpp"
+
+/**
+ * Build the tables
+ * @param degree
+ * @param plan
+ * @param derivatives Build the derivative tables as well
+ */
+BasisTable::BasisTable(const unsigned &degree, const SamplingPlan &plan, const bool &derivatives)
+        : degree(degree), plan(plan), derivatives(derivatives) {
+    const unsigned lanes = CurveBatch::LANES;
+    unsigned n = degree + 1, count = plan.size();
+    stride = (count + lanes - 1) / lanes * lanes;
+    BernsteinBasis basis(degree);
+    bySample.resize(count * n);
+    byCoefficient.assign(n * stride, 0.f);
+    if (derivatives) {
+        derivBySample.resize(count * n);
+        derivByCoefficient.assign(n * stride, 0.f);
+    }
+    for (unsigned k = 0; k < count; ++k) {
+        float *w = &bySample[k * n];
+        if (derivatives)
+            basis.derivatives(plan[k], w, &derivBySample[k * n]);
+        else
+            basis.weights(plan[k], w);
+        for (unsigned i = 0; i < n; ++i) {
+            byCoefficient[i * stride + k] = w[i];
+            if (derivatives)
+                derivByCoefficient[i * stride + k] = derivBySample[k * n + i];
+        }
+    }
+}
+
+/**
+ * Memory held by the tables
+ * @return
+ */
+std::size_t BasisTable::bytes() const {
+    return sizeof(BasisTable) + (bySample.size() + derivBySample.size() + byCoefficient.size() +
+                                 derivByCoefficient.size()) * sizeof(float);
+}
+
+/**
+ * Constructor, an empty cache
+ * @param capacity Bytes, 0 disables the cache
+ */
+BasisTableCache::BasisTableCache(const std::size_t &capacity) : capacityBytes(capacity) {}
+
+/**
+ * The cache shared by the whole process, created on first use with DEFAULT_CAPACITY
+ * @return
+ */
+BasisTableCache &BasisTableCache::instance() {
+    static BasisTableCache cache;
+    return cache;
+}
+
+/**
+ * Table of degree at the samples of plan, from the cache or built and inserted
+ * @param degree
+ * @param plan
+ * @param derivatives With the derivative tables
+ * @return
+ */
+std::shared_ptr<const BasisTable> BasisTableCache::get(const unsigned &degree, const SamplingPlan &plan,
+                                                       const bool &derivatives) {
+    Key key(degree, plan.size(), plan.domainMin(), plan.domainMax(), plan.isClosed(), derivatives);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            ++counters.hits;
+            found->second.lastUse = ++tick;
+            return found->second.table;
+        }
+        ++counters.misses;
+        if (capacityBytes == 0)
+            return std::make_shared<const BasisTable>(degree, plan, derivatives);
+    }
+
+    std::shared_ptr<const BasisTable> table = std::make_shared<const BasisTable>(degree, plan, derivatives);
+    std::lock_guard<std::mutex> lock(mutex);
+    //Another thread may have inserted the same table meanwhile
+    auto inserted = entries.insert(std::make_pair(key, Entry{table, 0}));
+    Entry &entry = inserted.first->second;
+    entry.lastUse = ++tick;
+    if (inserted.second) {
+        counters.bytes += table->bytes();
+        ++counters.entries;
+        evict();
+    }
+    return entry.table;
+}
+
+/**
+ * Drop the least recently used tables no caller holds until the cache fits its capacity.
+ * Called with the lock held
+ */
+void BasisTableCache::evict() {
+    while (counters.bytes > capacityBytes) {
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.table.use_count() == 1 &&
+                (oldest == entries.end() || it->second.lastUse < oldest->second.lastUse))
+                oldest = it;
+        if (oldest == entries.end())
+            return;
+        counters.bytes -= oldest->second.table->bytes();
+        --counters.entries;
+        ++counters.evictions;
+        entries.erase(oldest);
+    }
+}
+
+/**
+ * Change the capacity, dropping unused tables above it
+ * @param bytes 0 disables the cache
+ */
+void BasisTableCache::setCapacity(const std::size_t &bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacityBytes = bytes;
+    evict();
+}
+
+/**
+ * @return Capacity in bytes
+ */
+std::size_t BasisTableCache::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacityBytes;
+}
+
+/**
+ * @return Counters and current size
+ */
+BasisCacheStats BasisTableCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+/**
+ * Drop every table and reset the counters, tables still held by callers stay valid
+ */
+void BasisTableCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    counters = {0, 0, 0, 0, 0};
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "aligned.hpp"
+#include "samplingPlan.hpp"
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/**
+ * Bernstein values of one degree at every sample of a plan, in the two layouts of the tessellation kernels :
+ * by sample, bySample[k * (degree + 1) + i] = B_i(u_k), and by coefficient, byCoefficient[i * stride + k], rows
+ * padded with zeros to stride, a multiple of CurveBatch::LANES, and 32 bytes aligned for the packs.
+ * With derivatives, the same for the first derivatives B_i'(u_k)
+ */
+struct BasisTable {
+    unsigned degree;
+    SamplingPlan plan;
+    bool derivatives;
+    unsigned stride;
+    std::vector<float> bySample;
+    std::vector<float> derivBySample;
+    AlignedFloats byCoefficient;
+    AlignedFloats derivByCoefficient;
+
+    BasisTable(const unsigned &degree, const SamplingPlan &plan, const bool &derivatives);
+
+    std::size_t bytes() const;
+};
+
+//Counters of BasisTableCache, since the start or the last clear
+struct BasisCacheStats {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    unsigned entries;
+    std::size_t bytes;
+};
+
+/**
+ * Process-wide cache of basis tables keyed by (degree, sampling plan, derivatives), shared by every patch and
+ * curve of the same degree tessellated at the same samples, so that a scene of many patches computes each table
+ * once and its tessellation is only weighted sums over them.
+ * Tables are handed out as shared pointers : they stay valid while used, whatever the cache does. The cache is
+ * bounded to capacity() bytes, least recently used tables being dropped first, but only those no caller holds
+ * any more, so it may go over while more tables than that are in use. A capacity of 0 disables it, every get
+ * builds a new table.
+ * All the functions are thread-safe, tables are built outside the lock and the first one inserted wins.
+ */
+class BasisTableCache {
+private:
+    typedef std::tuple<unsigned, unsigned, float, float, bool, bool> Key;
+
+    struct Entry {
+        std::shared_ptr<const BasisTable> table;
+        unsigned long long lastUse;
+    };
+
+    mutable std::mutex mutex;
+    std::map<Key, Entry> entries;
+    std::size_t capacityBytes;
+    unsigned long long tick = 0;
+    BasisCacheStats counters = {0, 0, 0, 0, 0};
+
+    void evict();
+
+public:
+    //Default capacity, in bytes
+    static const std::size_t DEFAULT_CAPACITY = std::size_t(64) << 20;
+
+    explicit BasisTableCache(const std::size_t &capacity = DEFAULT_CAPACITY);
+
+    static BasisTableCache &instance();
+
+    std::shared_ptr<const BasisTable> get(const unsigned &degree, const SamplingPlan &plan,
+                                          const bool &derivatives = false);
+
+    void setCapacity(const std::size_t &bytes);
+
+    std::size_t capacity() const;
+
+    BasisCacheStats stats() const;
+
+    void clear();
+};
@@ -0,0 +1,28 @@
+#include "bench.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Replacement of the global operator new for the whole bench binary, every heap allocation is counted so that
+ * the benchmarks can report allocations per call. new[] and delete[] forward to these by default
+ */
+
+namespace {
+    std::atomic<unsigned long long> allocations(0);
+}
+
+unsigned long long allocationCount() {
+    return allocations.load();
+}
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
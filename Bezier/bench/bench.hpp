@@ -0,0 +1,105 @@
+#pragma once
+
+#include "vec.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * Small helpers shared by the benchmarks, each benchmark is a function listed in bench/main.cpp
+ */
+
+//Wall clock time in milliseconds
+inline double nowMs() {
+    return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//Control polygon of n points with coordinates in [0, scale)
+inline std::vector<Point> randomCtrlPts(std::mt19937 &rng, const unsigned &n, const float &scale = 10.f) {
+    std::uniform_real_distribution<float> d(0.f, scale);
+    std::vector<Point> pts;
+    for (unsigned i = 0; i < n; ++i)
+        pts.emplace_back(d(rng), d(rng), d(rng));
+    return pts;
+}
+
+//Largest distance between matching points of a and b
+inline float maxError(const std::vector<vec3> &a, const std::vector<vec3> &b) {
+    float err = 0;
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        float e = distance(Point(a[i]), Point(b[i]));
+        if (e > err) err = e;
+    }
+    return err;
+}
+
+//de Casteljau in double, reference for the error measures
+inline Point casteljauDouble(const std::vector<Point> &ctrl, const double &u) {
+    std::vector<double> x(ctrl.size()), y(ctrl.size()), z(ctrl.size());
+    for (size_t i = 0; i < ctrl.size(); ++i) {
+        x[i] = ctrl[i].x;
+        y[i] = ctrl[i].y;
+        z[i] = ctrl[i].z;
+    }
+    for (size_t i = 1; i < ctrl.size(); ++i)
+        for (size_t j = 0; j < ctrl.size() - i; ++j) {
+            x[j] = x[j] * (1 - u) + x[j + 1] * u;
+            y[j] = y[j] * (1 - u) + y[j + 1] * u;
+            z[j] = z[j] * (1 - u) + z[j + 1] * u;
+        }
+    return Point((float) x[0], (float) y[0], (float) z[0]);
+}
+
+//Number of operator new calls since the start of the program, counted by bench/allocations.cpp
+unsigned long long allocationCount();
+
+void benchCurveBatch();
+
+void benchForwardDiff();
+
+void benchAdaptive();
+
+void benchDegreeN();
+
+void benchBasis();
+
+void benchPowerBasis();
+
+void benchDerivatives();
+
+void benchArcLength();
+
+void benchClosestPoint();
+
+void benchIntersection();
+
+void benchBounds();
+
+void benchBSpline();
+
+void benchIncremental();
+
+void benchTessellateBatch();
+
+void benchSurfaceLayout();
+
+void benchSurfaceGrid();
+
+void benchSurfaceParallel();
+
+void benchCasteljau2D();
+
+void benchAdaptivePatch();
+
+void benchPatchSet();
+
+void benchSurfaceNormals();
+
+void benchMeshBuild();
+
+void benchBasisCache();
+
+void benchPatchModel();
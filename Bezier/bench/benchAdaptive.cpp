@@ -0,0 +1,109 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    /**
+     * Largest distance from 2048 curve points to the polyline
+     */
+    float polylineError(const std::vector<vec3> &dense, const std::vector<vec3> &poly) {
+        float err = 0;
+        for (const vec3 &q: dense) {
+            Point p(q);
+            float best = distance(p, Point(poly[0]));
+            for (size_t k = 0; k + 1 < poly.size(); ++k) {
+                Point a(poly[k]), b(poly[k + 1]);
+                Vector ab = b - a;
+                float t = length2(ab) > 0 ? std::min(1.f, std::max(0.f, dot(p - a, ab) / length2(ab))) : 0.f;
+                best = std::min(best, distance(p, a + ab * t));
+            }
+            err = std::max(err, best);
+        }
+        return err;
+    }
+
+    void uniform(const BezierCurve &curve, const unsigned &count, std::vector<vec3> &pts) {
+        pts.clear();
+        for (unsigned k = 0; k < count; ++k)
+            pts.emplace_back(curve.Casteljau(float(k) / float(count - 1)));
+    }
+
+    //Smallest uniform sample count with a polyline error of at most err, by bisection
+    unsigned uniformCount(const BezierCurve &curve, const std::vector<vec3> &dense, const float &err) {
+        std::vector<vec3> upts;
+        unsigned lo = 2, hi = 2;
+        for (uniform(curve, hi, upts); polylineError(dense, upts) > err; uniform(curve, hi, upts))
+            hi *= 2;
+        while (lo + 1 < hi) {
+            unsigned mid = (lo + hi) / 2;
+            uniform(curve, mid, upts);
+            if (polylineError(dense, upts) > err) lo = mid;
+            else hi = mid;
+        }
+        return hi;
+    }
+
+    //Uniform sample count guaranteeing epsilon from the second differences of the whole control polygon
+    unsigned boundCount(const std::vector<Point> &ctrl, const float &epsilon) {
+        float diff = 0;
+        for (size_t i = 0; i + 2 < ctrl.size(); ++i)
+            diff = std::max(diff, length(Vector(ctrl[i + 2]) - 2.f * Vector(ctrl[i + 1]) + Vector(ctrl[i])));
+        float d = float(ctrl.size() - 1);
+        return 1 + std::max(1u, (unsigned) std::ceil(std::sqrt(d * (d - 1) / 8 * diff / epsilon)));
+    }
+}
+
+/**
+ * Adaptive tessellation against uniform tessellations : the smallest one reaching the same chord error, known only
+ * by measuring it, and the one a uniform tessellator guaranteeing epsilon would use, from the second differences
+ * of the whole curve. On a profile with long flat spans and one tight bend, on random control polygons, then
+ * summed over 100 random cubics
+ */
+void benchAdaptive() {
+    std::mt19937 rng(3);
+    const float epsilons[] = {0.1f, 0.01f, 0.001f};
+    std::vector<std::vector<Point>> profiles = {
+            {Point(0, 0, 0), Point(4, 0, 0), Point(5, 0, 0), Point(5, 1, 0), Point(5, 5, 0)},
+            randomCtrlPts(rng, 4),
+            randomCtrlPts(rng, 8),
+    };
+
+    printf("%6s %8s %12s %12s %12s %12s %12s %12s\n", "ctrl", "epsilon", "adapt pts", "bound", "adapt error",
+           "uniform pts", "bound pts", "adapt ms");
+    for (const std::vector<Point> &profile: profiles) {
+        BezierCurve curve(profile);
+        std::vector<vec3> dense, pts;
+        uniform(curve, 2048, dense);
+        for (float epsilon: epsilons) {
+            double t0 = nowMs();
+            AdaptiveReport report = curve.CalculateCurvePointsAdaptive(pts, epsilon);
+            double t1 = nowMs();
+            float err = polylineError(dense, pts);
+            printf("%6u %8g %12u %12g %12g %12u %12u %12.3f\n", (unsigned) profile.size(), epsilon, report.nbPoints,
+                   report.chordError, err, uniformCount(curve, dense, err), boundCount(profile, epsilon), t1 - t0);
+        }
+    }
+
+    const unsigned nbCubics = 100;
+    std::vector<BezierCurve> cubics;
+    std::vector<std::vector<vec3>> denses(nbCubics);
+    for (unsigned c = 0; c < nbCubics; ++c) {
+        cubics.emplace_back(randomCtrlPts(rng, 4));
+        uniform(cubics[c], 1024, denses[c]);
+    }
+    printf("\n%u cubics %8s %12s %12s %12s %12s\n", nbCubics, "epsilon", "adapt pts", "uniform pts", "bound pts",
+           "worst error");
+    for (float epsilon: epsilons) {
+        unsigned adapt = 0, same = 0, bound = 0;
+        float worst = 0;
+        std::vector<vec3> pts;
+        for (unsigned c = 0; c < nbCubics; ++c) {
+            cubics[c].CalculateCurvePointsAdaptive(pts, epsilon);
+            float err = polylineError(denses[c], pts);
+            worst = std::max(worst, err);
+            adapt += pts.size();
+            same += uniformCount(cubics[c], denses[c], err);
+            bound += boundCount(cubics[c].getCtrlPts(), epsilon);
+        }
+        printf("%11s %8g %12u %12u %12u %12g\n", "", epsilon, adapt, same, bound, worst);
+    }
+}
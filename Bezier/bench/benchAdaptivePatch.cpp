@@ -0,0 +1,64 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+
+/**
+ * Row of bicubic patches going away from a 1024x768 camera, tessellated with a uniform 33x33 grid, with a world
+ * space tolerance and with a screen space tolerance : triangles and time for the whole row, triangles of the
+ * nearest and farthest patches, and patches stopped by the budget
+ */
+void benchAdaptivePatch() {
+    std::mt19937 rng(43);
+    const unsigned nbPatches = 64;
+    const unsigned budget = 4096;
+
+    std::vector<BezierSurface> patches;
+    for (unsigned p = 0; p < nbPatches; ++p) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < 4; ++i) {
+            std::vector<Point> row = randomCtrlPts(rng, 4, 1.f);
+            for (unsigned j = 0; j < 4; ++j)
+                row[j] = Point(float(i) * 4 / 3, row[j].y, float(p) * 8 + float(j) * 4 / 3);
+            net.push_back(row);
+        }
+        patches.emplace_back(net);
+    }
+    Orbiter camera;
+    //Camera at z = -10, looking along z
+    camera.lookat(Point(2, 0, -2), 8);
+    camera.projection(1024, 768, 45);
+
+    printf("%u bicubic patches 4x4 wide, one every 8 units away from the camera, budget %u triangles\n", nbPatches,
+           budget);
+    printf("%22s %12s %10s %10s %10s %8s\n", "", "triangles", "ms", "nearest", "farthest", "budget");
+    for (unsigned mode = 0; mode < 4; ++mode) {
+        Mesh mesh(GL_TRIANGLES);
+        unsigned nearest = 0, farthest = 0, budgetHits = 0;
+        double t0 = nowMs();
+        for (unsigned p = 0; p < nbPatches; ++p) {
+            int before = mesh.index_count();
+            if (mode == 0) {
+                std::vector<std::vector<vec3>> grid;
+                patches[p].CalculateSurfacePointsAnalytical(grid, 1.f / 32, 1.f / 32);
+                Mesh patch = BezierSurface::genMesh(grid);
+                for (const vec3 &pt: patch.positions())
+                    mesh.vertex(pt);
+                const unsigned *indices = (const unsigned *) patch.index_buffer();
+                int base = mesh.vertex_count() - patch.vertex_count();
+                for (int k = 0; k < patch.index_count(); k += 3)
+                    mesh.triangle(base + indices[k], base + indices[k + 1], base + indices[k + 2]);
+            } else {
+                PatchTessellationReport report = mode == 1
+                        ? patches[p].CalculateSurfaceMeshAdaptive(mesh, 0.01f, budget)
+                        : patches[p].CalculateSurfaceMeshAdaptive(mesh, camera, mode == 2 ? 1.f : 0.25f, budget);
+                budgetHits += report.budgetReached;
+            }
+            unsigned triangles = (mesh.index_count() - before) / 3;
+            if (p == 0) nearest = triangles;
+            if (p == nbPatches - 1) farthest = triangles;
+        }
+        double ms = nowMs() - t0;
+        const char *names[] = {"uniform 33x33", "world 0.01", "screen 1 pixel", "screen 0.25 pixel"};
+        printf("%22s %12d %10.3f %10u %10u %8u\n", names[mode], mesh.index_count() / 3, ms, nearest, farthest,
+               budgetHits);
+    }
+}
@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    /**
+     * Downstream re-sampling : dense uniform samples in u, cumulative polyline length, then linear
+     * interpolation at count equally spaced lengths
+     */
+    void resample(const BezierCurve &curve, const unsigned &dense, const unsigned &count, std::vector<vec3> &out) {
+        std::vector<vec3> pts;
+        curve.CalculateCurvePointsCasteljau(pts, 1.f / float(dense));
+        std::vector<float> cumul(pts.size(), 0.f);
+        for (size_t k = 1; k < pts.size(); ++k)
+            cumul[k] = cumul[k - 1] + distance(Point(pts[k - 1]), Point(pts[k]));
+        out.resize(count);
+        size_t k = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            float s = cumul.back() * i / (count - 1);
+            while (k + 2 < pts.size() && cumul[k + 1] < s)
+                ++k;
+            float span = cumul[k + 1] - cumul[k];
+            float t = span > 0 ? (s - cumul[k]) / span : 0.f;
+            out[i] = vec3(Point(pts[k]) + (Point(pts[k + 1]) - Point(pts[k])) * t);
+        }
+    }
+
+    //Largest deviation of the true arc length between consecutive points from the ideal spacing, relative to it
+    float spacingError(const ArcLengthTable &ref, const BezierCurve &curve, const std::vector<vec3> &pts) {
+        float ideal = ref.length() / float(pts.size() - 1);
+        float err = 0;
+        for (size_t k = 0; k < pts.size(); ++k) {
+            //Parameter of the point on the curve by the reference inverse, enough for the error measure
+            float s = ideal * k;
+            float expected = distance(Point(curve.Analytical(ref.param(s))), Point(pts[k]));
+            err = std::max(err, expected / ideal);
+        }
+        return err;
+    }
+}
+
+/**
+ * Equally spaced tessellation from the arc-length table against re-sampling a dense uniform tessellation,
+ * with the inverse accuracy measured on a 4096 spans reference table
+ */
+void benchArcLength() {
+    std::mt19937 rng(11);
+    const unsigned nbCurves = 256;
+    const unsigned count = 256;
+    const unsigned dense = 16 * count;
+
+    printf("%u curves, %u points each, re-sampling from %u samples\n", nbCurves, count, dense);
+    printf("%6s %10s %12s %12s %12s %12s %12s\n", "ctrl", "build us", "resample ms", "table ms", "inverse err",
+           "resample sp", "table sp");
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        std::vector<BezierCurve> curves;
+        std::vector<std::vector<Point>> ctrls;
+        for (unsigned c = 0; c < nbCurves; ++c) {
+            ctrls.push_back(randomCtrlPts(rng, n));
+            curves.emplace_back(ctrls.back());
+        }
+
+        double t0 = nowMs();
+        float sink = 0;
+        for (unsigned c = 0; c < nbCurves; ++c)
+            sink += ArcLengthTable(ctrls[c]).length();
+        double t1 = nowMs();
+
+        std::vector<vec3> pts;
+        for (unsigned c = 0; c < nbCurves; ++c) {
+            resample(curves[c], dense, count, pts);
+            sink += pts.back().x;
+        }
+        double t2 = nowMs();
+        for (unsigned c = 0; c < nbCurves; ++c) {
+            curves[c].CalculateCurvePointsArcLength(pts, count);
+            sink += pts.back().x;
+        }
+        double t3 = nowMs();
+
+        //Accuracy on a few curves
+        float inverseErr = 0, resampleSp = 0, tableSp = 0;
+        for (unsigned c = 0; c < 8; ++c) {
+            ArcLengthTable ref(ctrls[c], 4096);
+            for (unsigned k = 0; k <= 1000; ++k) {
+                float s = curves[c].length() * k / 1000;
+                inverseErr = std::max(inverseErr, std::abs(ref.lengthAt(curves[c].paramAtLength(s)) - s) / ref.length());
+            }
+            resample(curves[c], dense, count, pts);
+            resampleSp = std::max(resampleSp, spacingError(ref, curves[c], pts));
+            curves[c].CalculateCurvePointsArcLength(pts, count);
+            tableSp = std::max(tableSp, spacingError(ref, curves[c], pts));
+        }
+        printf("%6u %10.2f %12.3f %12.3f %12g %12g %12g%s\n", n, (t1 - t0) * 1000 / nbCurves, t2 - t1, t3 - t2,
+               inverseErr, resampleSp, tableSp, sink == 0 ? " " : "");
+    }
+}
@@ -0,0 +1,51 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+#include "Bezier/bspline.hpp"
+
+/**
+ * Per sample cost of cubic B-spline and NURBS evaluation as the number of control points grows, against
+ * the batched Bezier evaluation of the same control polygon (O(n) per sample, shown up to 64 points)
+ */
+void benchBSpline() {
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> weight(0.5f, 2.f);
+    const unsigned nbSamples = 1 << 18;
+    std::vector<float> params(nbSamples);
+    for (unsigned k = 0; k < nbSamples; ++k)
+        params[k] = float(k) / float(nbSamples - 1);
+
+    printf("%u samples, cubic, ns per sample\n", nbSamples);
+    printf("%8s %10s %10s %10s %10s %10s\n", "ctrl", "cox-de-boor", "de boor", "batch", "nurbs", "bezier");
+    for (unsigned n = 16; n <= 16384; n *= 4) {
+        std::vector<Point> ctrl = randomCtrlPts(rng, n);
+        std::vector<float> weights;
+        for (unsigned i = 0; i < n; ++i)
+            weights.push_back(weight(rng));
+        BSplineCurve spline(ctrl, 3);
+        NurbsCurve nurbs(ctrl, weights, 3);
+
+        std::vector<vec3> out(nbSamples);
+        double t0 = nowMs();
+        for (unsigned k = 0; k < nbSamples; ++k)
+            out[k] = spline.CoxDeBoor(params[k]);
+        double t1 = nowMs();
+        for (unsigned k = 0; k < nbSamples; ++k)
+            out[k] = spline.DeBoor(params[k]);
+        double t2 = nowMs();
+        spline.Evaluate(params, out);
+        double t3 = nowMs();
+        nurbs.Evaluate(params, out);
+        double t4 = nowMs();
+
+        double ns = 1e6 / nbSamples;
+        printf("%8u %10.2f %10.2f %10.2f %10.2f", n, (t1 - t0) * ns, (t2 - t1) * ns, (t3 - t2) * ns,
+               (t4 - t3) * ns);
+        if (n <= 64) {
+            CurveBatch bezier(ctrl);
+            double t5 = nowMs();
+            bezier.Analytical(params, out);
+            printf(" %10.2f", (nowMs() - t5) * ns);
+        }
+        printf("\n");
+    }
+}
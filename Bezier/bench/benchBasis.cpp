@@ -0,0 +1,37 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+/**
+ * Analytical evaluation of high degree curves against de Casteljau, throughput and error per degree
+ */
+void benchBasis() {
+    std::mt19937 rng(5);
+    const unsigned nbParams = 1 << 15;
+    printf("%u points per curve, error against de Casteljau in double\n", nbParams);
+    printf("%6s %14s %14s %14s %12s %12s %12s\n", "ctrl", "casteljau Mpt/s", "analytic Mpt/s", "batch Mpt/s",
+           "cast error", "anal error", "batch error");
+    for (unsigned n = 4; n <= 64; n *= 2) {
+        std::vector<Point> ctrl = randomCtrlPts(rng, n);
+        BezierCurve curve(ctrl);
+        std::vector<float> params(nbParams);
+        std::vector<vec3> ref(nbParams), cast(nbParams), anal(nbParams), batch;
+        for (unsigned k = 0; k < nbParams; ++k) {
+            params[k] = float(k) / float(nbParams - 1);
+            ref[k] = casteljauDouble(ctrl, params[k]);
+        }
+
+        double t0 = nowMs();
+        for (unsigned k = 0; k < nbParams; ++k)
+            cast[k] = curve.Casteljau(params[k]);
+        double t1 = nowMs();
+        for (unsigned k = 0; k < nbParams; ++k)
+            anal[k] = curve.Analytical(params[k]);
+        double t2 = nowMs();
+        CurveBatch(ctrl).Analytical(params, batch);
+        double t3 = nowMs();
+
+        printf("%6u %14.2f %14.2f %14.2f %12g %12g %12g\n", n, nbParams / (t1 - t0) / 1000,
+               nbParams / (t2 - t1) / 1000, nbParams / (t3 - t2) / 1000,
+               maxError(ref, cast), maxError(ref, anal), maxError(ref, batch));
+    }
+}
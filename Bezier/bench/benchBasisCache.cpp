@@ -0,0 +1,101 @@
+#include "bench.hpp"
+#include "Bezier/basisTableCache.hpp"
+#include "Bezier/patchSetTessellator.hpp"
+#include "Bezier/surface2D.hpp"
+
+namespace {
+    bool sameGrid(const std::vector<std::vector<vec3>> &a, const std::vector<std::vector<vec3>> &b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].size() != b[i].size())
+                return false;
+            for (size_t j = 0; j < a[i].size(); ++j)
+                if (a[i][j].x != b[i][j].x || a[i][j].y != b[i][j].y || a[i][j].z != b[i][j].z)
+                    return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * 4096 bicubic patches tessellated one by one at 17x17 and 65x65 samples, points and frames, and all together by
+ * PatchSetTessellator, with the basis tables rebuilt for each patch (cache capacity 0) and shared through the
+ * cache. Time, lookups, tables held, and whether the grids are the same.
+ * Then 64 sample counts in turn with a cache too small for them all, the tables no patch holds are dropped
+ */
+void benchBasisCache() {
+    std::mt19937 rng(61);
+    const unsigned nbPatches = 4096;
+    std::vector<BezierSurface> patches;
+    for (unsigned p = 0; p < nbPatches; ++p) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < 4; ++i)
+            net.push_back(randomCtrlPts(rng, 4));
+        patches.emplace_back(net);
+    }
+    BasisTableCache &cache = BasisTableCache::instance();
+    const std::size_t capacity = cache.capacity();
+
+    printf("%18s %8s %12s %12s %10s %10s %8s\n", "", "samples", "no cache ms", "cache ms", "lookups", "KB",
+           "same");
+    const unsigned resolutions[] = {17, 65};
+    for (unsigned frames = 0; frames < 2; ++frames)
+        for (unsigned n: resolutions) {
+            SamplingPlan plan(n);
+            std::vector<std::vector<vec3>> pts, normals, ref, refNormals;
+            double ms[2];
+            for (unsigned cached = 0; cached < 2; ++cached) {
+                cache.setCapacity(cached ? capacity : 0);
+                cache.clear();
+                double t0 = nowMs();
+                for (const BezierSurface &patch: patches)
+                    if (frames)
+                        patch.CalculateSurfaceFramesAnalytical(pts, normals, plan, plan);
+                    else
+                        patch.CalculateSurfacePointsAnalytical(pts, plan, plan);
+                ms[cached] = nowMs() - t0;
+                if (!cached) {
+                    ref = pts;
+                    refNormals = normals;
+                }
+            }
+            BasisCacheStats stats = cache.stats();
+            printf("%18s %8u %12.3f %12.3f %10llu %10.1f %8s\n", frames ? "frames" : "points", n * n, ms[0], ms[1],
+                   stats.hits + stats.misses, stats.bytes / 1024., sameGrid(pts, ref) &&
+                   (!frames || sameGrid(normals, refNormals)) ? "yes" : "NO");
+        }
+
+    //The last patch again, so that the grids compared are those of the same patch
+    PatchSetTessellator tessellator(1e-3f);
+    double ms[2];
+    std::vector<vec3> positions[2];
+    for (unsigned cached = 0; cached < 2; ++cached) {
+        cache.setCapacity(cached ? capacity : 0);
+        cache.clear();
+        Mesh mesh(GL_TRIANGLES);
+        double t0 = nowMs();
+        tessellator.tessellate(patches, mesh);
+        ms[cached] = nowMs() - t0;
+        positions[cached] = mesh.positions();
+    }
+    BasisCacheStats stats = cache.stats();
+    printf("%18s %8u %12.3f %12.3f %10llu %10.1f %8s\n", "patch set", (unsigned) positions[1].size(), ms[0], ms[1],
+           stats.hits + stats.misses, stats.bytes / 1024., sameGrid({positions[0]}, {positions[1]}) ? "yes" : "NO");
+
+    //Bounded : 64 resolutions, each table about 4 * n * 2 floats, in a cache of a quarter of them
+    cache.clear();
+    cache.setCapacity(256 * 1024);
+    std::vector<std::vector<vec3>> pts;
+    std::size_t peak = 0;
+    for (unsigned k = 0; k < 64; ++k) {
+        SamplingPlan plan(1000 + 32 * k);
+        patches[k].CalculateSurfacePointsAnalytical(pts, plan, SamplingPlan(2));
+        peak = std::max(peak, cache.stats().bytes);
+    }
+    stats = cache.stats();
+    printf("\nbounded to %zu KB : %u tables held, %.1f KB, peak %.1f KB, %llu evictions\n", cache.capacity() / 1024,
+           stats.entries, stats.bytes / 1024., peak / 1024., stats.evictions);
+    cache.clear();
+    cache.setCapacity(capacity);
+}
@@ -0,0 +1,65 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    float volume(const Point &pmin, const Point &pmax) {
+        Vector d = pmax - pmin;
+        return d.x * d.y * d.z;
+    }
+}
+
+/**
+ * Exact curve bounds against the control point box and the box of a 1025 points tessellation : time per curve,
+ * volume relative to the exact bounds, and largest distance between the exact and the tessellation box faces
+ */
+void benchBounds() {
+    std::mt19937 rng(17);
+    const unsigned nbCurves = 1 << 14;
+
+    printf("%u curves\n", nbCurves);
+    printf("%6s %10s %10s %12s %12s %12s %12s\n", "ctrl", "hull us", "exact us", "sampled us", "hull vol",
+           "sampled vol", "exact-sampled");
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        std::vector<std::vector<Point>> curves;
+        for (unsigned c = 0; c < nbCurves; ++c)
+            curves.push_back(randomCtrlPts(rng, n));
+
+        std::vector<Point> hullMin(nbCurves), hullMax(nbCurves), exactMin, exactMax;
+        double t0 = nowMs();
+        for (unsigned c = 0; c < nbCurves; ++c)
+            controlBounds(curves[c].data(), n, hullMin[c], hullMax[c]);
+        double t1 = nowMs();
+        curveBounds(curves, exactMin, exactMax);
+        double t2 = nowMs();
+
+        //Tessellation bounds on a subset
+        const unsigned nbSampled = 1024;
+        std::vector<Point> sampledMin(nbSampled), sampledMax(nbSampled);
+        std::vector<vec3> pts;
+        double t3 = nowMs();
+        for (unsigned c = 0; c < nbSampled; ++c) {
+            BezierCurve(curves[c]).CalculateCurvePointsCasteljau(pts, 1.f / 1024.f);
+            sampledMin[c] = sampledMax[c] = Point(pts[0]);
+            for (const vec3 &p: pts) {
+                sampledMin[c] = min(sampledMin[c], Point(p));
+                sampledMax[c] = max(sampledMax[c], Point(p));
+            }
+        }
+        double t4 = nowMs();
+
+        double hullVol = 0, sampledVol = 0;
+        float gap = 0;
+        for (unsigned c = 0; c < nbSampled; ++c) {
+            float exact = volume(exactMin[c], exactMax[c]);
+            hullVol += volume(hullMin[c], hullMax[c]) / exact;
+            sampledVol += volume(sampledMin[c], sampledMax[c]) / exact;
+            for (unsigned axis = 0; axis < 3; ++axis) {
+                gap = std::max(gap, std::abs(exactMin[c](axis) - sampledMin[c](axis)));
+                gap = std::max(gap, std::abs(exactMax[c](axis) - sampledMax[c](axis)));
+            }
+        }
+        printf("%6u %10.3f %10.3f %12.3f %12.3f %12.4f %12g\n", n, (t1 - t0) * 1000 / nbCurves,
+               (t2 - t1) * 1000 / nbCurves, (t4 - t3) * 1000 / nbSampled, hullVol / nbSampled,
+               sampledVol / nbSampled, gap);
+    }
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+#include <cassert>
+
+namespace {
+    //Casteljau2D as it was, one vector for the row points and one copy of each row per sample
+    Point vectorCasteljau(const std::vector<Point> &pts, const float &u) {
+        std::vector<Point> tmp(pts);
+        float u1 = 1 - u;
+        for (size_t i = 1; i < tmp.size(); ++i)
+            for (size_t j = 0; j < tmp.size() - i; ++j)
+                tmp[j] = tmp[j] * u1 + tmp[j + 1] * u;
+        return tmp[0];
+    }
+
+    vec3 vectorCasteljau2D(const std::vector<std::vector<Point>> &net, const float &u, const float &v) {
+        std::vector<Point> pts;
+        for (const std::vector<Point> &row: net)
+            pts.emplace_back(vectorCasteljau(row, v));
+        return vectorCasteljau(pts, u);
+    }
+}
+
+/**
+ * BezierSurface::Casteljau2D with stack or caller scratch against the former version allocating one vector per
+ * row and sample : time and heap allocations per sample, and largest difference, which must be 0.
+ * Asserts that neither version allocates per sample, whatever the net size : the stack version is called once
+ * before timing, so the per thread scratch of the nets above STACK_SCRATCH already has its size
+ */
+void benchCasteljau2D() {
+    std::mt19937 rng(41);
+    const unsigned nbSamples = 1 << 16;
+
+    printf("%u samples, stack scratch up to %u rows plus points per row\n", nbSamples, BezierSurface::STACK_SCRATCH);
+    printf("%8s %10s %10s %10s %10s %10s %10s %10s\n", "net", "vector ns", "allocs", "stack ns", "allocs",
+           "scratch ns", "allocs", "max error");
+    const unsigned sizes[] = {4, 8, 16, 32, 40};
+    for (unsigned n: sizes) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < n; ++i)
+            net.push_back(randomCtrlPts(rng, n));
+        BezierSurface surface(net);
+        std::vector<float> us(nbSamples), vs(nbSamples);
+        std::uniform_real_distribution<float> d(0.f, 1.f);
+        for (unsigned k = 0; k < nbSamples; ++k) {
+            us[k] = d(rng);
+            vs[k] = d(rng);
+        }
+        std::vector<vec3> ref(nbSamples), stack(nbSamples), scratched(nbSamples);
+        std::vector<Point> scratch(surface.casteljauScratchSize());
+
+        //Sizes the per thread scratch of the large nets
+        stack[0] = surface.Casteljau2D(us[0], vs[0]);
+
+        unsigned long long a0 = allocationCount();
+        double t0 = nowMs();
+        for (unsigned k = 0; k < nbSamples; ++k)
+            ref[k] = vectorCasteljau2D(net, us[k], vs[k]);
+        unsigned long long a1 = allocationCount();
+        double t1 = nowMs();
+        for (unsigned k = 0; k < nbSamples; ++k)
+            stack[k] = surface.Casteljau2D(us[k], vs[k]);
+        unsigned long long a2 = allocationCount();
+        double t2 = nowMs();
+        for (unsigned k = 0; k < nbSamples; ++k)
+            scratched[k] = surface.Casteljau2D(us[k], vs[k], scratch.data());
+        unsigned long long a3 = allocationCount();
+        double t3 = nowMs();
+
+        assert(a2 == a1);
+        assert(a3 == a2);
+        double perSample = 1e6 / nbSamples;
+        printf("%3ux%-4u %10.1f %10.2f %10.1f %10.2f %10.1f %10.2f %10g\n", n, n, (t1 - t0) * perSample,
+               double(a1 - a0) / nbSamples, (t2 - t1) * perSample, double(a2 - a1) / nbSamples,
+               (t3 - t2) * perSample, double(a3 - a2) / nbSamples,
+               std::max(maxError(ref, stack), maxError(ref, scratched)));
+    }
+}
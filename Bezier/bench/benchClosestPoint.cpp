@@ -0,0 +1,75 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    //Nearest of the sampled curve points, the brute force approach
+    ClosestPoint bruteForce(const std::vector<vec3> &samples, const Point &q) {
+        ClosestPoint best;
+        best.distance = -1;
+        for (size_t k = 0; k < samples.size(); ++k) {
+            float d = distance(q, Point(samples[k]));
+            if (best.distance < 0 || d < best.distance) {
+                best.distance = d;
+                best.point = samples[k];
+                best.u = float(k) / float(samples.size() - 1);
+            }
+        }
+        return best;
+    }
+}
+
+/**
+ * Batched closest point queries against brute force sampling of the curve (1025 samples), on scan points
+ * scattered around the curve and on points spread in its bounding box. The gap column is how much farther
+ * the brute force result is than the tree one, the tree error being the Newton tolerance
+ */
+void benchClosestPoint() {
+    std::mt19937 rng(5);
+    const unsigned nbQueries = 1 << 16;
+    const unsigned nbBrute = 1 << 10;
+    std::uniform_real_distribution<float> unit(0.f, 1.f), box(-2.f, 12.f), noise(-0.2f, 0.2f);
+
+    printf("%u queries per curve, brute force on the first %u\n", nbQueries, nbBrute);
+    printf("%6s %6s %8s %10s %12s %12s %10s %12s\n", "ctrl", "set", "leaves", "build us", "brute q/s", "tree q/s",
+           "speedup", "gap");
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        BezierCurve curve(randomCtrlPts(rng, n));
+        std::vector<vec3> samples;
+        curve.CalculateCurvePointsCasteljau(samples, 1.f / 1024.f);
+
+        std::vector<Point> pts;
+        for (unsigned k = 0; k < n; ++k)
+            pts.push_back(Point(curve.Casteljau(float(k) / float(n - 1))));
+        double t0 = nowMs();
+        CurveProjector projector(pts);
+        for (unsigned r = 0; r < 99; ++r)
+            projector.changeCtrlPts(pts);
+        double buildUs = (nowMs() - t0) * 10;
+
+        for (unsigned set = 0; set < 2; ++set) {
+            std::vector<Point> queries;
+            for (unsigned k = 0; k < nbQueries; ++k) {
+                if (set == 0)
+                    queries.push_back(Point(curve.Casteljau(unit(rng))) + Vector(noise(rng), noise(rng), noise(rng)));
+                else
+                    queries.emplace_back(box(rng), box(rng), box(rng));
+            }
+
+            std::vector<ClosestPoint> brute(nbBrute);
+            double t1 = nowMs();
+            for (unsigned k = 0; k < nbBrute; ++k)
+                brute[k] = bruteForce(samples, queries[k]);
+            double t2 = nowMs();
+            std::vector<ClosestPoint> tree;
+            curve.ClosestPoints(queries, tree);
+            double t3 = nowMs();
+
+            float gap = -1e30f;
+            for (unsigned k = 0; k < nbBrute; ++k)
+                gap = std::max(gap, brute[k].distance - tree[k].distance);
+            double bruteRate = nbBrute / (t2 - t1) * 1000, treeRate = nbQueries / (t3 - t2) * 1000;
+            printf("%6u %6s %8u %10.2f %12.0f %12.0f %10.1f %12g\n", n, set == 0 ? "scan" : "box",
+                   projector.nbLeaves(), buildUs, bruteRate, treeRate, treeRate / bruteRate, gap);
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+/**
+ * Batched evaluator against one-at-a-time BezierCurve::Casteljau, error and throughput per degree
+ */
+void benchCurveBatch() {
+    std::mt19937 rng(1);
+    const unsigned nbParams = 1 << 16;
+    std::vector<float> params(nbParams);
+    for (unsigned k = 0; k < nbParams; ++k)
+        params[k] = float(k) / float(nbParams - 1);
+
+    printf("isa %s, %u parameters per curve\n", CurveBatch::isa(), nbParams);
+    printf("%6s %12s %12s %12s %12s\n", "ctrl", "scalar ms", "batch ms", "speedup", "max error");
+    for (unsigned n = 2; n <= 16; n += 2) {
+        std::vector<Point> pts = randomCtrlPts(rng, n);
+        BezierCurve curve(pts);
+        CurveBatch batch(pts);
+
+        std::vector<vec3> ref(nbParams), out;
+        double t0 = nowMs();
+        for (unsigned k = 0; k < nbParams; ++k)
+            ref[k] = curve.Casteljau(params[k]);
+        double t1 = nowMs();
+        batch.Casteljau(params, out);
+        double t2 = nowMs();
+
+        printf("%6u %12.3f %12.3f %12.2f %12g\n", n, t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1), maxError(ref, out));
+    }
+}
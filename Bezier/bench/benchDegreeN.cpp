@@ -0,0 +1,44 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+#include "Bezier/surface2D.hpp"
+
+/**
+ * Degree specialized evaluators against the generic de Casteljau evaluators, object sizes
+ */
+void benchDegreeN() {
+    std::mt19937 rng(4);
+    printf("sizeof BezierCurve %u, BezierSurface %u, BezierCurveN<3> %u, BezierPatchN<3, 3> %u\n",
+           (unsigned) sizeof(BezierCurve), (unsigned) sizeof(BezierSurface),
+           (unsigned) sizeof(BezierCurveN<3>), (unsigned) sizeof(BezierPatchN<3, 3>));
+
+    const unsigned nbParams = 1 << 20;
+    std::vector<Point> ctrl = randomCtrlPts(rng, 4);
+    BezierCurve curve(ctrl);
+    BezierCurveN<3> cubic(ctrl.data());
+    std::vector<vec3> ref(nbParams), out(nbParams);
+    double t0 = nowMs();
+    for (unsigned k = 0; k < nbParams; ++k)
+        ref[k] = curve.Casteljau(float(k) / float(nbParams));
+    double t1 = nowMs();
+    for (unsigned k = 0; k < nbParams; ++k)
+        out[k] = cubic.Analytical(float(k) / float(nbParams));
+    double t2 = nowMs();
+    printf("cubic curve, %u points : casteljau %.3f ms, BezierCurveN<3> %.3f ms, max error %g\n",
+           nbParams, t1 - t0, t2 - t1, maxError(ref, out));
+
+    std::vector<std::vector<Point>> net;
+    for (unsigned i = 0; i < 4; ++i)
+        net.push_back(randomCtrlPts(rng, 4));
+    BezierSurface surface(net);
+    std::vector<std::vector<vec3>> refGrid, outGrid;
+    t0 = nowMs();
+    surface.CalculateSurfacePointsCasteljau(refGrid, 0.001f, 0.001f);
+    t1 = nowMs();
+    surface.CalculateSurfacePointsAnalytical(outGrid, 0.001f, 0.001f);
+    t2 = nowMs();
+    float err = 0;
+    for (size_t i = 0; i < refGrid.size() && i < outGrid.size(); ++i)
+        err = std::max(err, maxError(refGrid[i], outGrid[i]));
+    printf("bicubic patch, step 0.001 : casteljau %.3f ms, BezierPatchN<3, 3> %.3f ms, max error %g\n",
+           t1 - t0, t2 - t1, err);
+}
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    //Control points of the derivative curve, scaled by the degree
+    std::vector<Point> hodograph(const std::vector<Point> &ctrl) {
+        std::vector<Point> h;
+        float d = float(ctrl.size() - 1);
+        for (size_t i = 0; i + 1 < ctrl.size(); ++i)
+            h.push_back(Point((ctrl[i + 1] - ctrl[i]) * d));
+        return h;
+    }
+}
+
+/**
+ * Position and derivatives from one pyramid against three separate evaluations of the curve and its hodographs
+ */
+void benchDerivatives() {
+    std::mt19937 rng(7);
+    const unsigned nbParams = 1 << 16;
+    const unsigned nbCurves = 32;
+    std::vector<float> params(nbParams);
+    for (unsigned k = 0; k < nbParams; ++k)
+        params[k] = float(k) / float(nbParams - 1);
+
+    printf("%u curves of %u samples\n", nbCurves, nbParams);
+    printf("%6s %12s %12s %12s %12s %12s\n", "ctrl", "separate ms", "combined ms", "speedup", "d1 error", "d2 error");
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        std::vector<std::vector<Point>> ctrls;
+        for (unsigned c = 0; c < nbCurves; ++c)
+            ctrls.push_back(randomCtrlPts(rng, n));
+
+        std::vector<vec3> pos, d1, d2, sp, sd1, sd2;
+        float err1 = 0, err2 = 0;
+        double separate = 0, combined = 0;
+        for (unsigned c = 0; c < nbCurves; ++c) {
+            BezierCurve curve(ctrls[c]);
+            CurveBatch p(ctrls[c]), h1(hodograph(ctrls[c])), h2(hodograph(hodograph(ctrls[c])));
+            double t0 = nowMs();
+            p.Casteljau(params, sp);
+            h1.Casteljau(params, sd1);
+            h2.Casteljau(params, sd2);
+            double t1 = nowMs();
+            curve.Derivatives(params, pos, d1, d2);
+            double t2 = nowMs();
+            separate += t1 - t0;
+            combined += t2 - t1;
+            err1 = std::max(err1, maxError(sd1, d1));
+            err2 = std::max(err2, maxError(sd2, d2));
+        }
+        printf("%6u %12.3f %12.3f %12.2f %12g %12g\n", n, separate, combined, separate / combined, err1, err2);
+    }
+}
@@ -0,0 +1,43 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+/**
+ * Forward differencing against the Casteljau tessellation, error and time per step and re-anchoring period
+ * over a set of random curves
+ */
+void benchForwardDiff() {
+    std::mt19937 rng(2);
+    const unsigned nbCurves = 200;
+    const float steps[] = {0.01f, 0.001f, 0.0001f};
+    const unsigned reanchors[] = {0, 1024, 128, 16};
+
+    printf("%u curves per line\n", nbCurves);
+    printf("%6s %8s %9s %12s %12s %12s\n", "ctrl", "step", "reanchor", "casteljau ms", "forward ms", "max error");
+    for (unsigned n = 4; n <= 8; n += 2) {
+        std::vector<BezierCurve> curves;
+        for (unsigned c = 0; c < nbCurves; ++c)
+            curves.emplace_back(randomCtrlPts(rng, n));
+        for (float step: steps) {
+            //Outputs are filled once before timing so that both modes write to warm buffers
+            std::vector<std::vector<vec3>> ref(nbCurves), out(nbCurves);
+            for (unsigned c = 0; c < nbCurves; ++c) {
+                curves[c].CalculateCurvePointsCasteljau(ref[c], step);
+                curves[c].CalculateCurvePointsForward(out[c], step);
+            }
+            double t0 = nowMs();
+            for (unsigned c = 0; c < nbCurves; ++c)
+                curves[c].CalculateCurvePointsCasteljau(ref[c], step);
+            double t1 = nowMs();
+            for (unsigned reanchor: reanchors) {
+                double t2 = nowMs();
+                for (unsigned c = 0; c < nbCurves; ++c)
+                    curves[c].CalculateCurvePointsForward(out[c], step, reanchor);
+                double t3 = nowMs();
+                float err = 0;
+                for (unsigned c = 0; c < nbCurves; ++c)
+                    err = std::max(err, maxError(ref[c], out[c]));
+                printf("%6u %8g %9u %12.3f %12.3f %12g\n", n, step, reanchor, t1 - t0, t3 - t2, err);
+            }
+        }
+    }
+}
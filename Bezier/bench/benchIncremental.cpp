@@ -0,0 +1,85 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+#include "Bezier/surface2D.hpp"
+
+namespace {
+    struct Move {
+        unsigned i;
+        unsigned j;
+        Vector delta;
+    };
+
+    std::vector<Move> randomMoves(std::mt19937 &rng, const unsigned &count, const unsigned &nu, const unsigned &nv) {
+        std::uniform_real_distribution<float> d(-0.1f, 0.1f);
+        std::vector<Move> moves;
+        for (unsigned m = 0; m < count; ++m) {
+            Move move;
+            move.i = rng() % nu;
+            move.j = rng() % nv;
+            move.delta = Vector(d(rng), d(rng), d(rng));
+            moves.push_back(move);
+        }
+        return moves;
+    }
+}
+
+/**
+ * Control point drags : full re-tessellation after each move against patching the existing points with
+ * moveCtrlPt, on two copies of the same curve or patch, and the drift of the patched points after the moves
+ */
+void benchIncremental() {
+    std::mt19937 rng(23);
+    const unsigned nbMoves = 200;
+
+    printf("%u moves\n", nbMoves);
+    printf("%12s %8s %12s %12s %10s %12s\n", "", "ctrl", "full us", "patch us", "speedup", "drift");
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        const float step = 1.f / 4096.f;
+        BezierCurve curve(randomCtrlPts(rng, n)), copy(curve);
+        std::vector<Move> moves = randomMoves(rng, nbMoves, n, 1);
+        std::vector<vec3> full, patched;
+        curve.CalculateCurvePointsAnalytical(patched, step);
+
+        double t0 = nowMs();
+        for (const Move &move: moves) {
+            copy.moveCtrlPt(move.i, move.delta);
+            copy.CalculateCurvePointsAnalytical(full, step);
+        }
+        double t1 = nowMs();
+        for (const Move &move: moves)
+            curve.moveCtrlPt(move.i, move.delta, patched, step);
+        double t2 = nowMs();
+
+        double fullUs = (t1 - t0) * 1000 / nbMoves, patchUs = (t2 - t1) * 1000 / nbMoves;
+        printf("%12s %8u %12.2f %12.2f %10.1f %12g\n", "curve 4097", n, fullUs, patchUs, fullUs / patchUs,
+               maxError(full, patched));
+    }
+
+    for (unsigned n = 4; n <= 16; n *= 2) {
+        const float step = 1.f / 256.f;
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < n; ++i)
+            net.push_back(randomCtrlPts(rng, n));
+        BezierSurface surface(net), copy(net);
+        std::vector<Move> moves = randomMoves(rng, nbMoves, n, n);
+        std::vector<std::vector<vec3>> full, patched;
+        surface.CalculateSurfacePointsAnalytical(patched, step, step);
+
+        double t0 = nowMs();
+        for (const Move &move: moves) {
+            copy.moveCtrlPt(move.i, move.j, move.delta);
+            copy.CalculateSurfacePointsAnalytical(full, step, step);
+        }
+        double t1 = nowMs();
+        for (const Move &move: moves)
+            surface.moveCtrlPt(move.i, move.j, move.delta, patched, step, step);
+        double t2 = nowMs();
+
+        float drift = 0;
+        for (unsigned a = 0; a < full.size(); ++a)
+            drift = std::max(drift, maxError(full[a], patched[a]));
+        double fullUs = (t1 - t0) * 1000 / nbMoves, patchUs = (t2 - t1) * 1000 / nbMoves;
+        printf("%12s %8u %12.2f %12.2f %10.1f %12g\n", "patch 257^2", n * n, fullUs, patchUs, fullUs / patchUs,
+               drift);
+    }
+}
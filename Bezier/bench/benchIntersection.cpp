@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+namespace {
+    //Planar cubic of extent `size` at a random place of a square of side `side`
+    std::vector<Point> planarCubic(std::mt19937 &rng, const float &side, const float &size) {
+        std::uniform_real_distribution<float> place(0.f, side), local(0.f, size);
+        Point origin(place(rng), place(rng), 0);
+        std::vector<Point> ctrl;
+        for (unsigned i = 0; i < 4; ++i)
+            ctrl.push_back(origin + Vector(local(rng), local(rng), 0));
+        return ctrl;
+    }
+}
+
+/**
+ * All intersections of random planar cubic sets : pairs per second over all the n (n - 1) / 2 pairs,
+ * with and without the broad phase, and the residual distance of the hits
+ */
+void benchIntersection() {
+    std::mt19937 rng(13);
+    CurveIntersector intersector;
+
+    printf("%8s %10s %12s %10s %12s %12s %14s %12s\n", "curves", "pairs", "candidates", "hits", "all ms",
+           "broad ms", "pairs/s", "residual");
+    for (unsigned n = 250; n <= 4000; n *= 2) {
+        std::vector<std::vector<Point>> curves;
+        for (unsigned c = 0; c < n; ++c)
+            curves.push_back(planarCubic(rng, 100.f, 10.f));
+        double nbPairs = double(n) * (n - 1) / 2;
+
+        std::vector<std::pair<unsigned, unsigned>> candidates;
+        CurveIntersector::candidatePairs(curves, candidates);
+
+        std::vector<CurvePairIntersection> hits;
+        double t0 = nowMs();
+        intersector.intersect(curves, hits);
+        double t1 = nowMs();
+
+        //Without the broad phase, on the 250 first curves only
+        unsigned nbBrute = std::min(n, 250u);
+        std::vector<CurveIntersection> pairHits;
+        unsigned bruteHits = 0;
+        double t2 = nowMs();
+        for (unsigned i = 0; i < nbBrute; ++i)
+            for (unsigned j = i + 1; j < nbBrute; ++j) {
+                intersector.intersect(curves[i], curves[j], pairHits);
+                bruteHits += pairHits.size();
+            }
+        double t3 = nowMs();
+        double brutePairs = double(nbBrute) * (nbBrute - 1) / 2;
+
+        float residual = 0;
+        for (const CurvePairIntersection &h: hits) {
+            BezierCurve a(curves[h.first]), b(curves[h.second]);
+            residual = std::max(residual, distance(Point(a.Casteljau(h.hit.u)), Point(b.Casteljau(h.hit.v))));
+        }
+        printf("%8u %10.0f %12zu %10zu %12.2f %12.2f %14.0f %12g\n", n, nbPairs, candidates.size(), hits.size(),
+               (t3 - t2) * nbPairs / brutePairs, t1 - t0, nbPairs / (t1 - t0) * 1000, residual);
+        if (n == 250)
+            printf("%8s %10s %12s %10u (all pairs, no broad phase)\n", "", "", "", bruteHits);
+    }
+}
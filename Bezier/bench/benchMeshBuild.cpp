@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+#include "Bezier/surface2D.hpp"
+
+namespace {
+    //genMesh as it was, one Mesh::vertex and Mesh::triangle call at a time, with the rows indexed by their size
+    Mesh genMeshPerCall(const std::vector<std::vector<vec3>> &surfacePts) {
+        Mesh tmp(GL_TRIANGLES);
+        unsigned n = surfacePts.size(), m = n > 0 ? surfacePts[0].size() : 0;
+        for (unsigned i = 0; i < n; ++i)
+            for (const vec3 &pt: surfacePts[i])
+                tmp.vertex(pt);
+        for (unsigned i = 0; i + 1 < n; ++i)
+            for (unsigned j = 0; j + 1 < m; ++j) {
+                tmp.triangle(i * m + j, i * m + j + 1, (i + 1) * m + j);
+                tmp.triangle((i + 1) * m + j, i * m + j + 1, (i + 1) * m + j + 1);
+            }
+        return tmp;
+    }
+
+    //makeSOR as it was, with the rotations of the bulk version
+    Mesh makeSORPerCall(const std::vector<vec3> &curvePts, const float &rotStep) {
+        Mesh tmp(GL_TRIANGLES);
+        SamplingPlan angles = SamplingPlan::periodic(rotStep, 0, 360);
+        for (unsigned k = 0; k < angles.size(); ++k) {
+            Transform rot = RotationY(angles[k]);
+            for (const vec3 &pt: curvePts)
+                tmp.vertex((Point) rot(vec4(pt, 1)));
+        }
+        unsigned nbRota = tmp.vertex_count() / curvePts.size();
+        unsigned nb = curvePts.size();
+        for (unsigned j = 0; j + 1 < nbRota; ++j)
+            for (unsigned i = 0; i + 1 < nb; ++i) {
+                tmp.triangle(j * nb + i, (j + 1) * nb + i, j * nb + i + 1);
+                tmp.triangle((j + 1) * nb + i, (j + 1) * nb + i + 1, j * nb + i + 1);
+            }
+        for (unsigned i = 0; i + 1 < nb; ++i) {
+            tmp.triangle((nbRota - 1) * nb + i, i, (nbRota - 1) * nb + i + 1);
+            tmp.triangle(i, i + 1, (nbRota - 1) * nb + i + 1);
+        }
+        return tmp;
+    }
+
+    bool samePoints(const std::vector<vec3> &a, const std::vector<vec3> &b) {
+        if (a.size() != b.size())
+            return false;
+        for (size_t k = 0; k < a.size(); ++k)
+            if (a[k].x != b[k].x || a[k].y != b[k].y || a[k].z != b[k].z)
+                return false;
+        return true;
+    }
+
+    bool sameMesh(const Mesh &a, const Mesh &b) {
+        return samePoints(a.positions(), b.positions()) && samePoints(a.normals(), b.normals()) &&
+               a.indices() == b.indices();
+    }
+}
+
+/**
+ * Mesh construction only, from a 1000x1000 grid and from the surface of revolution of a 1000 points curve with
+ * 1000 rotations : the former per call genMesh and makeSOR against the bulk ones, and genMesh with normals.
+ * Time, and whether the meshes are the same
+ */
+void benchMeshBuild() {
+    std::mt19937 rng(59);
+    const unsigned n = 1000;
+    std::vector<std::vector<Point>> net;
+    for (unsigned i = 0; i < 4; ++i)
+        net.push_back(randomCtrlPts(rng, 4));
+    BezierSurface surface(net);
+    std::vector<std::vector<vec3>> pts, normals;
+    surface.CalculateSurfaceFramesAnalytical(pts, normals, SamplingPlan(n), SamplingPlan(n));
+    BezierCurve curve(randomCtrlPts(rng, 4));
+    std::vector<vec3> curvePts;
+    curve.CalculateCurvePointsAnalytical(curvePts, SamplingPlan(n));
+    const float rotStep = 0.36f;
+
+    printf("%22s %10s %10s %10s %8s\n", "", "vertices", "triangles", "ms", "same");
+    for (unsigned mode = 0; mode < 5; ++mode) {
+        double t0 = nowMs();
+        Mesh mesh = mode == 0 ? genMeshPerCall(pts)
+                  : mode == 1 ? BezierSurface::genMesh(pts)
+                  : mode == 2 ? BezierSurface::genMesh(pts, normals)
+                  : mode == 3 ? makeSORPerCall(curvePts, rotStep)
+                  : BezierCurve::makeSOR(curvePts, rotStep);
+        double ms = nowMs() - t0;
+        const char *names[] = {"genMesh per call", "genMesh bulk", "genMesh bulk normals", "makeSOR per call",
+                               "makeSOR bulk"};
+        const char *same = "";
+        if (mode == 1)
+            same = sameMesh(mesh, genMeshPerCall(pts)) ? "yes" : "NO";
+        if (mode == 4)
+            same = sameMesh(mesh, makeSORPerCall(curvePts, rotStep)) ? "yes" : "NO";
+        printf("%22s %10d %10d %10.3f %8s\n", names[mode], mesh.vertex_count(), mesh.index_count() / 3, ms, same);
+    }
+}
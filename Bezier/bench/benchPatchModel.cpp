@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "Bezier/patchModel.hpp"
+#include "Bezier/surface2D.hpp"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    //Largest coordinate difference between the points of two models of the same patch sizes, -1 if they differ
+    float modelError(const PatchModel &a, const PatchModel &b) {
+        if (a.size() != b.size() || a.getCtrlPts().size() != b.getCtrlPts().size())
+            return -1;
+        for (unsigned k = 0; k < a.size(); ++k)
+            if (a.sizeU(k) != b.sizeU(k) || a.sizeV(k) != b.sizeV(k) || a.offset(k) != b.offset(k))
+                return -1;
+        float error = 0;
+        for (size_t m = 0; m < a.getCtrlPts().size(); ++m) {
+            const Point &p = a.getCtrlPts()[m], &q = b.getCtrlPts()[m];
+            error = std::max(error, std::max(std::abs(p.x - q.x), std::max(std::abs(p.y - q.y), std::abs(p.z - q.z))));
+        }
+        return error;
+    }
+}
+
+/**
+ * 50000 patches, bicubic and one in eight 6x4, written in the text and the binary formats then loaded back.
+ * File size, read and parse times, patches per second, and largest difference with the written points
+ */
+void benchPatchModel() {
+    std::mt19937 rng(67);
+    const unsigned nbPatches = 50000;
+    PatchModel model;
+    for (unsigned k = 0; k < nbPatches; ++k) {
+        unsigned nu = k % 8 == 7 ? 6 : 4, nv = 4;
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < nu; ++i)
+            net.push_back(randomCtrlPts(rng, nv, 100.f));
+        model.add(BezierSurface(net));
+    }
+    const char *files[] = {"bench_patches.bpt", "bench_patches.bptb"};
+    if (!model.saveText(files[0]) || !model.saveBinary(files[1]))
+        return;
+
+    printf("%8s %10s %10s %10s %10s %14s %12s\n", "format", "patches", "MB", "read ms", "parse ms", "patches/s",
+           "max error");
+    for (const char *file: files) {
+        PatchModel loaded;
+        PatchModelReport report;
+        loaded.load(file, &report);
+        printf("%8s %10u %10.2f %10.3f %10.3f %14.0f %12g\n", report.binary ? "binary" : "text", report.nbPatches,
+               report.bytes / 1048576., report.readMs, report.parseMs, report.patchesPerSecond,
+               modelError(model, loaded));
+        std::remove(file);
+    }
+}
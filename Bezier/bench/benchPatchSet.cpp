@@ -0,0 +1,116 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+#include "Bezier/patchSetTessellator.hpp"
+#include <map>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    //Edges used by one triangle only, apart from those on the border of the model, x or z close to 0 or size
+    unsigned openEdges(const Mesh &mesh, const float &size) {
+        std::map<std::pair<unsigned, unsigned>, unsigned> uses;
+        const unsigned *indices = (const unsigned *) mesh.index_buffer();
+        for (int k = 0; k < mesh.index_count(); k += 3)
+            for (unsigned e = 0; e < 3; ++e) {
+                unsigned a = indices[k + e], b = indices[k + (e + 1) % 3];
+                ++uses[std::make_pair(std::min(a, b), std::max(a, b))];
+            }
+        const std::vector<vec3> &positions = mesh.positions();
+        unsigned open = 0;
+        for (const auto &use: uses) {
+            if (use.second != 1)
+                continue;
+            const vec3 &p = positions[use.first.first], &q = positions[use.first.second];
+            auto on = [](const float &a, const float &b, const float &c) {
+                return std::abs(a - c) < 1e-4f && std::abs(b - c) < 1e-4f;
+            };
+            bool border = on(p.x, q.x, 0) || on(p.x, q.x, size) || on(p.z, q.z, 0) || on(p.z, q.z, size);
+            open += !border;
+        }
+        return open;
+    }
+}
+
+/**
+ * Terrain of KxK bicubic patches cut from one C0 control grid, bumpier towards one corner, so that neighbours ask
+ * for different rates : each patch meshed alone with genMesh at its largest rate, against PatchSetTessellator
+ * with 1, 2, 4... threads. Vertices, triangles, open edges inside the model (cracks and unwelded seams) and time
+ */
+void benchPatchSet() {
+    std::mt19937 rng(47);
+    const unsigned K = 32;
+    const unsigned n = 3 * K + 1;
+    const float size = float(K);
+    std::uniform_real_distribution<float> d(-1.f, 1.f);
+    std::vector<Point> grid(n * n);
+    for (unsigned i = 0; i < n; ++i)
+        for (unsigned j = 0; j < n; ++j) {
+            float amplitude = 0.05f + 0.5f * float(i + j) / float(2 * n);
+            grid[i * n + j] = Point(float(i) / 3, amplitude * d(rng), float(j) / 3);
+        }
+    std::vector<BezierSurface> patches;
+    for (unsigned pi = 0; pi < K; ++pi)
+        for (unsigned pj = 0; pj < K; ++pj) {
+            std::vector<Point> net;
+            for (unsigned i = 0; i < 4; ++i)
+                for (unsigned j = 0; j < 4; ++j)
+                    net.push_back(grid[(3 * pi + i) * n + 3 * pj + j]);
+            patches.emplace_back(4, 4, net);
+        }
+
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads();
+#else
+    int maxThreads = 1;
+#endif
+    const float epsilon = 0.002f;
+    PatchSetTessellator tessellator(epsilon, 64);
+
+    printf("%u bicubic patches, tolerance %g, %d threads available\n", K * K, epsilon, maxThreads);
+    printf("%22s %8s %10s %10s %8s %10s\n", "", "threads", "vertices", "triangles", "open", "ms");
+    {
+        Mesh mesh(GL_TRIANGLES);
+        double t0 = nowMs();
+        for (const BezierSurface &patch: patches) {
+            unsigned segU, segV;
+            tessellator.segments(patch, segU, segV);
+            float step = 1.f / std::max(segU, segV);
+            std::vector<std::vector<vec3>> pts;
+            patch.CalculateSurfacePointsAnalytical(pts, step, step);
+            Mesh piece = BezierSurface::genMesh(pts);
+            int base = mesh.vertex_count();
+            for (const vec3 &pt: piece.positions())
+                mesh.vertex(pt);
+            const unsigned *indices = (const unsigned *) piece.index_buffer();
+            for (int k = 0; k < piece.index_count(); k += 3)
+                mesh.triangle(base + indices[k], base + indices[k + 1], base + indices[k + 2]);
+        }
+        double ms = nowMs() - t0;
+        printf("%22s %8d %10d %10d %8u %10.3f\n", "genMesh per patch", 1, mesh.vertex_count(),
+               mesh.index_count() / 3, openEdges(mesh, size), ms);
+    }
+
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(maxThreads);
+    for (int threads: counts) {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+        Mesh mesh(GL_TRIANGLES);
+        double t0 = nowMs();
+        PatchSetReport report = tessellator.tessellate(patches, mesh);
+        double ms = nowMs() - t0;
+        printf("%22s %8d %10u %10u %8u %10.3f\n", "PatchSetTessellator", threads, report.nbVertices,
+               report.nbTriangles, openEdges(mesh, size), ms);
+        if (threads == counts.back())
+            printf("%u edges, %u shared\n", report.nbEdges, report.nbSharedEdges);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
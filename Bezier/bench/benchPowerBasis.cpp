@@ -0,0 +1,44 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+/**
+ * Power basis Horner evaluation against de Casteljau and the Bernstein engine per degree, errors against
+ * de Casteljau in double. The crossover is the highest degree where Horner is faster than de Casteljau and within 1e-4
+ */
+void benchPowerBasis() {
+    std::mt19937 rng(6);
+    const unsigned nbParams = 1 << 16;
+    std::vector<float> params(nbParams);
+    for (unsigned k = 0; k < nbParams; ++k)
+        params[k] = float(k) / float(nbParams - 1);
+
+    unsigned crossover = 0;
+    printf("%6s %12s %12s %12s %12s %12s %12s\n", "ctrl", "casteljau ms", "bernstein ms", "horner ms",
+           "cast error", "bern error", "horner error");
+    for (unsigned n = 2; n <= 24; n += 2) {
+        std::vector<Point> ctrl = randomCtrlPts(rng, n);
+        BezierCurve curve(ctrl);
+        std::vector<vec3> ref(nbParams), cast(nbParams), bern(nbParams), horner(nbParams);
+        for (unsigned k = 0; k < nbParams; ++k)
+            ref[k] = casteljauDouble(ctrl, params[k]);
+
+        double t0 = nowMs();
+        for (unsigned k = 0; k < nbParams; ++k)
+            cast[k] = curve.Casteljau(params[k]);
+        double t1 = nowMs();
+        for (unsigned k = 0; k < nbParams; ++k)
+            bern[k] = curve.Analytical(params[k]);
+        double t2 = nowMs();
+        curve.setPowerBasis(true);
+        for (unsigned k = 0; k < nbParams; ++k)
+            horner[k] = curve.Horner(params[k]);
+        double t3 = nowMs();
+
+        float hornerErr = maxError(ref, horner);
+        if (t3 - t2 < t1 - t0 && hornerErr < 1e-4f)
+            crossover = n;
+        printf("%6u %12.3f %12.3f %12.3f %12g %12g %12g\n", n, t1 - t0, t2 - t1, t3 - t2,
+               maxError(ref, cast), maxError(ref, bern), hornerErr);
+    }
+    printf("horner is faster than casteljau and within 1e-4 up to %u control points\n", crossover);
+}
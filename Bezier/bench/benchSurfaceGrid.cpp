@@ -0,0 +1,39 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+
+/**
+ * CalculateSurfacePointsAnalytical, separable matrix products, against the point by point evaluation of
+ * OldCalculateSurfacePointsAnalytical (Analytical2D, the degree specialized evaluators up to bi-quintic nets)
+ * at step 0.001 : time and largest difference, relative to the largest control point coordinate
+ */
+void benchSurfaceGrid() {
+    std::mt19937 rng(31);
+    const float step = 0.001f;
+
+    printf("step %g\n", step);
+    printf("%8s %12s %12s %10s %12s\n", "net", "per point ms", "grid ms", "speedup", "rel error");
+    const unsigned sizes[] = {2, 3, 4, 6, 8, 12, 16};
+    for (unsigned n: sizes) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < n; ++i)
+            net.push_back(randomCtrlPts(rng, n));
+        BezierSurface surface(net);
+
+        std::vector<std::vector<vec3>> ref, out;
+        double t0 = nowMs();
+        surface.OldCalculateSurfacePointsAnalytical(ref, step, step);
+        double t1 = nowMs();
+        const unsigned repeat = 4;
+        for (unsigned r = 0; r < repeat; ++r)
+            surface.CalculateSurfacePointsAnalytical(out, step, step);
+        double t2 = nowMs();
+
+        float err = 0;
+        for (size_t i = 0; i < ref.size() && i < out.size(); ++i)
+            err = std::max(err, maxError(ref[i], out[i]));
+        if (ref.size() != out.size() || ref[0].size() != out[0].size())
+            err = INFINITY;
+        printf("%3ux%-4u %12.3f %12.3f %10.1f %12g\n", n, n, t1 - t0, (t2 - t1) / repeat,
+               (t1 - t0) * repeat / (t2 - t1), err / 10);
+    }
+}
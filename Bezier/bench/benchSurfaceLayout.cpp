@@ -0,0 +1,105 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+
+namespace {
+    /**
+     * CalculateSurfacePointsAnalytical as it was with one vector per row : specialized evaluator when the rows
+     * have the same length and both degrees are at most 5, otherwise one Bernstein basis per row
+     */
+    void nestedAnalytical(const std::vector<std::vector<Point>> &net, std::vector<std::vector<vec3>> &surfacePts,
+                          const float &step) {
+        surfacePts.clear();
+        unsigned nu = net.size();
+        bool uniform = true;
+        for (const std::vector<Point> &row: net)
+            uniform = uniform && row.size() == net[0].size();
+        PatchEvaluatorN eval = uniform ? patchEvaluatorN(nu, net[0].size()) : nullptr;
+        std::vector<float> params;
+        SamplingPlan::fromStep(step).params(params);
+        if (eval) {
+            const Point *rows[6];
+            for (unsigned i = 0; i < nu; ++i)
+                rows[i] = net[i].data();
+            for (float i: params) {
+                surfacePts.emplace_back();
+                for (float j: params)
+                    surfacePts.back().emplace_back(eval(rows, i, j));
+            }
+            return;
+        }
+
+        BernsteinBasis basisU(nu - 1);
+        std::vector<BernsteinBasis> basisRows;
+        for (const std::vector<Point> &row: net)
+            basisRows.emplace_back(row.size() - 1);
+        const std::vector<float> &vs = params;
+        unsigned nbV = vs.size();
+        std::vector<Point> rowPts(nu * nbV);
+        for (unsigned k = 0; k < nu; ++k)
+            for (unsigned j = 0; j < nbV; ++j)
+                rowPts[k * nbV + j] = basisRows[k].Analytical(net[k].data(), vs[j]);
+        std::vector<float> wu(nu + 1);
+        for (float i: params) {
+            surfacePts.emplace_back();
+            basisU.weights(i, wu.data());
+            for (unsigned j = 0; j < nbV; ++j) {
+                Point pt(0, 0, 0);
+                for (unsigned k = 0; k < nu; ++k)
+                    pt = pt + rowPts[k * nbV + j] * wu[k];
+                surfacePts.back().emplace_back(pt);
+            }
+        }
+    }
+
+    float gridError(const std::vector<std::vector<vec3>> &a, const std::vector<std::vector<vec3>> &b) {
+        float err = 0;
+        for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+            err = std::max(err, maxError(a[i], b[i]));
+        return err;
+    }
+}
+
+/**
+ * CalculateSurfacePointsAnalytical with the dense row-major grid, with and without the coordinate planes, against
+ * the former storage of one vector per row, and the error of a ragged net rebuilt by degree elevation
+ */
+void benchSurfaceLayout() {
+    std::mt19937 rng(29);
+    const float step = 1.f / 256.f;
+    const unsigned repeat = 8;
+
+    printf("step 1/256, %u runs\n", repeat);
+    printf("%8s %12s %12s %12s %10s %12s\n", "net", "nested ms", "grid ms", "planar ms", "speedup", "max error");
+    const unsigned sizes[] = {4, 6, 8, 12, 16, 24};
+    for (unsigned n: sizes) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < n; ++i)
+            net.push_back(randomCtrlPts(rng, n));
+        BezierSurface grid(net), planar(net);
+        planar.setPlanar(true);
+
+        std::vector<std::vector<vec3>> ref, out, outPlanar;
+        double t0 = nowMs();
+        for (unsigned r = 0; r < repeat; ++r)
+            nestedAnalytical(net, ref, step);
+        double t1 = nowMs();
+        for (unsigned r = 0; r < repeat; ++r)
+            grid.CalculateSurfacePointsAnalytical(out, step, step);
+        double t2 = nowMs();
+        for (unsigned r = 0; r < repeat; ++r)
+            planar.CalculateSurfacePointsAnalytical(outPlanar, step, step);
+        double t3 = nowMs();
+        double best = std::min(t2 - t1, t3 - t2);
+        printf("%3ux%-4u %12.3f %12.3f %12.3f %10.2f %12g\n", n, n, (t1 - t0) / repeat, (t2 - t1) / repeat,
+               (t3 - t2) / repeat, (t1 - t0) / best, std::max(gridError(ref, out), gridError(ref, outPlanar)));
+    }
+
+    //Rows of 3 to 10 points
+    std::vector<std::vector<Point>> ragged;
+    for (unsigned i = 0; i < 8; ++i)
+        ragged.push_back(randomCtrlPts(rng, 3 + i));
+    std::vector<std::vector<vec3>> ref, out;
+    nestedAnalytical(ragged, ref, step);
+    BezierSurface(ragged).CalculateSurfacePointsAnalytical(out, step, step);
+    printf("ragged net, rows of 3 to 10 points elevated to 10 : max error %g\n", gridError(ref, out));
+}
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+#include <cmath>
+
+namespace {
+    //Vertex normals of the grid as the sum of the normals of the genMesh triangles around each vertex
+    void faceNormals(const std::vector<std::vector<vec3>> &pts, std::vector<std::vector<vec3>> &normals) {
+        size_t n = pts.size(), m = pts.empty() ? 0 : pts[0].size();
+        normals.assign(n, std::vector<vec3>(m, vec3(0, 0, 0)));
+        auto add = [&](const size_t &ia, const size_t &ja, const size_t &ib, const size_t &jb, const size_t &ic,
+                       const size_t &jc) {
+            Vector f = cross(Point(pts[ib][jb]) - Point(pts[ia][ja]), Point(pts[ic][jc]) - Point(pts[ia][ja]));
+            for (const std::pair<size_t, size_t> &v: {std::make_pair(ia, ja), std::make_pair(ib, jb),
+                                                       std::make_pair(ic, jc)})
+                normals[v.first][v.second] = vec3(Vector(normals[v.first][v.second]) + f);
+        };
+        for (size_t i = 0; i + 1 < n; ++i)
+            for (size_t j = 0; j + 1 < m; ++j) {
+                add(i, j, i, j + 1, i + 1, j);
+                add(i + 1, j, i, j + 1, i + 1, j + 1);
+            }
+        for (std::vector<vec3> &row: normals)
+            for (vec3 &nrm: row)
+                nrm = vec3(normalize(Vector(nrm)));
+    }
+
+    //Largest angle in degrees between matching normals
+    float maxAngle(const std::vector<std::vector<vec3>> &a, const std::vector<std::vector<vec3>> &b) {
+        float cosine = 1;
+        for (size_t i = 0; i < a.size(); ++i)
+            for (size_t j = 0; j < a[i].size(); ++j)
+                cosine = std::min(cosine, dot(Vector(a[i][j]), Vector(b[i][j])));
+        return std::acos(std::max(-1.f, std::min(1.f, cosine))) * 180 / float(M_PI);
+    }
+}
+
+/**
+ * Grids of a smooth bicubic patch and of a 16x16 patch : points alone, points with analytic normals, with
+ * tangents as well, and points followed by the usual second pass averaging the triangle normals around each
+ * vertex. Time, and largest angle between the averaged and the analytic normals
+ */
+void benchSurfaceNormals() {
+    std::mt19937 rng(53);
+    printf("%6s %8s %12s %12s %12s %12s %14s\n", "net", "samples", "points ms", "normals ms", "tangents ms",
+           "faces ms", "faces error");
+    const unsigned nets[] = {4, 16};
+    const unsigned resolutions[] = {64, 256, 1024};
+    for (unsigned n: nets) {
+        //Height field over the unit square, so that the averaged normals are meaningful
+        std::vector<std::vector<Point>> net;
+        std::uniform_real_distribution<float> d(0.f, 0.5f);
+        for (unsigned i = 0; i < n; ++i) {
+            net.emplace_back();
+            for (unsigned j = 0; j < n; ++j)
+                net.back().emplace_back(float(i) / float(n - 1), d(rng), float(j) / float(n - 1));
+        }
+        BezierSurface surface(net);
+        for (unsigned res: resolutions) {
+            float step = 1.f / res;
+            std::vector<std::vector<vec3>> pts, normals, tangents, averaged;
+            //Untimed run so that no version pays for the first allocation of the grid
+            surface.CalculateSurfaceFramesAnalytical(pts, normals, step, step, &tangents);
+
+            double t0 = nowMs();
+            surface.CalculateSurfacePointsAnalytical(pts, step, step);
+            double t1 = nowMs();
+            surface.CalculateSurfaceFramesAnalytical(pts, normals, step, step);
+            double t2 = nowMs();
+            surface.CalculateSurfaceFramesAnalytical(pts, normals, step, step, &tangents);
+            double t3 = nowMs();
+            surface.CalculateSurfacePointsAnalytical(pts, step, step);
+            faceNormals(pts, averaged);
+            double t4 = nowMs();
+            printf("%3ux%-2u %8u %12.3f %12.3f %12.3f %12.3f %13.3f°\n", n, n, (unsigned) (pts.size() * pts[0].size()),
+                   t1 - t0, t2 - t1, t3 - t2, t4 - t3, maxAngle(averaged, normals));
+        }
+    }
+}
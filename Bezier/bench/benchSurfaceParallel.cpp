@@ -0,0 +1,80 @@
+#include "bench.hpp"
+#include "Bezier/surface2D.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    float gridError(const std::vector<std::vector<vec3>> &a, const std::vector<std::vector<vec3>> &b) {
+        float err = 0;
+        for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+            err = std::max(err, maxError(a[i], b[i]));
+        return a.size() == b.size() ? err : INFINITY;
+    }
+}
+
+/**
+ * CalculateSurfacePointsAnalytical and CalculateSurfacePointsCasteljau of a bicubic and a 16x16 patch at several
+ * resolutions, with 1, 2, 4... threads up to the OpenMP maximum : time, speedup over one thread, and largest
+ * difference with the single thread grid, which must stay 0
+ */
+void benchSurfaceParallel() {
+    std::mt19937 rng(37);
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads();
+#else
+    int maxThreads = 1;
+#endif
+    //Powers of two, then the maximum
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(maxThreads);
+
+    printf("%d threads available\n", maxThreads);
+    printf("%10s %6s %10s %8s %10s %10s %12s\n", "method", "net", "samples", "threads", "ms", "speedup", "diff 1 thread");
+    const unsigned nets[] = {4, 16};
+    const unsigned resolutions[] = {256, 1024, 2048};
+    for (unsigned n: nets) {
+        std::vector<std::vector<Point>> net;
+        for (unsigned i = 0; i < n; ++i)
+            net.push_back(randomCtrlPts(rng, n));
+        BezierSurface surface(net);
+
+        for (unsigned method = 0; method < 2; ++method)
+            for (unsigned res: resolutions) {
+                //de Casteljau is too slow for large grids and nets
+                if (method == 1 && n * res > 1024)
+                    continue;
+                float step = 1.f / res;
+                std::vector<std::vector<vec3>> single, out;
+                //Untimed run, so that the first timing does not include allocating the grid
+                if (method == 0)
+                    surface.CalculateSurfacePointsAnalytical(out, step, step);
+                else
+                    surface.CalculateSurfacePointsCasteljau(out, step, step);
+                double oneThread = 0;
+                for (int threads: counts) {
+#ifdef _OPENMP
+                    omp_set_num_threads(threads);
+#endif
+                    double t0 = nowMs();
+                    if (method == 0)
+                        surface.CalculateSurfacePointsAnalytical(out, step, step);
+                    else
+                        surface.CalculateSurfacePointsCasteljau(out, step, step);
+                    double ms = nowMs() - t0;
+                    if (threads == 1) {
+                        oneThread = ms;
+                        single = out;
+                    }
+                    printf("%10s %3ux%-2u %9u^2 %8d %10.3f %10.2f %12g\n", method == 0 ? "analytical" : "casteljau",
+                           n, n, (unsigned) out.size(), threads, ms, oneThread / ms, gridError(single, out));
+                }
+            }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
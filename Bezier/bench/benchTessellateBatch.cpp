@@ -0,0 +1,70 @@
+#include "bench.hpp"
+#include "Bezier/bezier.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * BezierCurve::tessellateBatch on a library of curves of mixed degrees, with every thread count from 1 to the
+ * number of cores : time, speedup over one thread, parallel efficiency checked against LINEAR_EFFICIENCY, and
+ * largest difference with a serial loop of CalculateCurvePointsAnalytical
+ */
+void benchTessellateBatch() {
+    //Scaling counts as linear while the efficiency stays above this
+    const double LINEAR_EFFICIENCY = 0.8;
+    std::mt19937 rng(23);
+    const unsigned nbCurves = 1 << 14;
+    const float step = 1.f / 256.f;
+
+    std::vector<BezierCurve> curves;
+    curves.reserve(nbCurves);
+    for (unsigned c = 0; c < nbCurves; ++c)
+        curves.emplace_back(randomCtrlPts(rng, 3 + c % 14));
+
+    double t0 = nowMs();
+    std::vector<vec3> serial, pts;
+    serial.reserve(nbCurves * 257);
+    for (const BezierCurve &curve: curves) {
+        curve.CalculateCurvePointsAnalytical(pts, step);
+        serial.insert(serial.end(), pts.begin(), pts.end());
+    }
+    double serialMs = nowMs() - t0;
+
+#ifdef _OPENMP
+    int maxThreads = omp_get_max_threads(), cores = omp_get_num_procs();
+#else
+    int maxThreads = 1, cores = 1;
+#endif
+    printf("%u curves, 3 to 16 control points, %u points per curve, %d cores\n", nbCurves,
+           (unsigned) (serial.size() / nbCurves), cores);
+    printf("serial loop %.3f ms\n", serialMs);
+    printf("%8s %10s %10s %10s %8s %12s\n", "threads", "ms", "speedup", "effic.", "linear", "max error");
+
+    std::vector<vec3> out;
+    std::vector<unsigned> offsets;
+    double oneThread = 0;
+    int linearUpTo = 0;
+    for (int threads = 1; threads <= cores; ++threads) {
+#ifdef _OPENMP
+        omp_set_num_threads(threads);
+#endif
+        const unsigned repeat = 4;
+        double t1 = nowMs();
+        for (unsigned r = 0; r < repeat; ++r)
+            BezierCurve::tessellateBatch(curves, step, out, offsets);
+        double ms = (nowMs() - t1) / repeat;
+        if (threads == 1)
+            oneThread = ms;
+        double efficiency = oneThread / ms / threads;
+        bool linear = efficiency >= LINEAR_EFFICIENCY;
+        if (linear && linearUpTo == threads - 1)
+            linearUpTo = threads;
+        printf("%8d %10.3f %10.2f %9.0f%% %8s %12g\n", threads, ms, oneThread / ms, 100 * efficiency,
+               linear ? "yes" : "no", maxError(out, serial));
+    }
+    printf("efficiency above %.0f%% up to %d of %d threads\n", 100 * LINEAR_EFFICIENCY, linearUpTo, cores);
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+}
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include <cstring>
+
+namespace {
+    struct Bench {
+        const char *name;
+
+        void (*run)();
+    };
+
+    const Bench benches[] = {
+            {"curve_batch", benchCurveBatch},
+            {"forward_diff", benchForwardDiff},
+            {"adaptive", benchAdaptive},
+            {"degree_n", benchDegreeN},
+            {"basis", benchBasis},
+            {"power_basis", benchPowerBasis},
+            {"derivatives", benchDerivatives},
+            {"arc_length", benchArcLength},
+            {"closest_point", benchClosestPoint},
+            {"intersection", benchIntersection},
+            {"bounds", benchBounds},
+            {"bspline", benchBSpline},
+            {"incremental", benchIncremental},
+            {"tessellate_batch", benchTessellateBatch},
+            {"surface_layout", benchSurfaceLayout},
+            {"surface_grid", benchSurfaceGrid},
+            {"surface_parallel", benchSurfaceParallel},
+            {"casteljau_2d", benchCasteljau2D},
+            {"adaptive_patch", benchAdaptivePatch},
+            {"patch_set", benchPatchSet},
+            {"surface_normals", benchSurfaceNormals},
+            {"mesh_build", benchMeshBuild},
+            {"basis_cache", benchBasisCache},
+            {"patch_model", benchPatchModel},
+    };
+}
+
+/**
+ * bezier_bench [name...] runs the named benchmarks, or all of them without arguments
+ */
+int main(int argc, char **argv) {
+    for (const Bench &b: benches) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected = selected || strcmp(argv[i], b.name) == 0;
+        if (!selected)
+            continue;
+        printf("== %s\n", b.name);
+        b.run();
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "bernstein.hpp"
+
+/**
+ * Constructor, generates the binomial row of the degree
+ * @param degree
+ */
+BernsteinBasis::BernsteinBasis(const unsigned &degree) : degree(degree), binomials(degree + 1, 1.) {
+    for (unsigned k = 1; k < degree; ++k)
+        binomials[k] = binomials[k - 1] * (degree - k + 1) / k;
+}
+
+/**
+ * x^e by squaring
+ * @param x
+ * @param e
+ * @return
+ */
+double BernsteinBasis::ipow(double x, unsigned e) {
+    double r = 1;
+    while (e) {
+        if (e & 1) r *= x;
+        x *= x;
+        e >>= 1;
+    }
+    return r;
+}
+
+/**
+ * Values of the degree + 1 Bernstein polynomials at u
+ * @param u
+ * @param w Filled with degree + 1 weights
+ */
+void BernsteinBasis::weights(const float &u, float *w) const {
+    double du = u;
+    if (du <= 0.5) {
+        double t = du / (1 - du);
+        double p = ipow(1 - du, degree);
+        for (unsigned i = 0; i <= degree; ++i) {
+            w[i] = (float) (binomials[i] * p);
+            p *= t;
+        }
+    } else {
+        double s = (1 - du) / du;
+        double p = ipow(du, degree);
+        for (unsigned i = degree + 1; i-- > 0;) {
+            w[i] = (float) (binomials[i] * p);
+            p *= s;
+        }
+    }
+}
+
+/**
+ * Values and first derivatives of the degree + 1 Bernstein polynomials at u, from the basis of degree - 1 :
+ * B(i, n)' = n (B(i - 1, n - 1) - B(i, n - 1)), with C(n - 1, i) = C(n, i) (n - i) / n
+ * @param u
+ * @param w Filled with degree + 1 weights
+ * @param d Filled with degree + 1 derivatives
+ */
+void BernsteinBasis::derivatives(const float &u, float *w, float *d) const {
+    weights(u, w);
+    if (degree == 0) {
+        d[0] = 0;
+        return;
+    }
+    //d[i] = B(i, n - 1)(u) first, scaled as in weights
+    double du = u, n = degree;
+    d[degree] = 0;
+    if (du <= 0.5) {
+        double t = du / (1 - du);
+        double p = ipow(1 - du, degree - 1);
+        for (unsigned i = 0; i < degree; ++i) {
+            d[i] = (float) (binomials[i] * (degree - i) / n * p);
+            p *= t;
+        }
+    } else {
+        double s = (1 - du) / du;
+        double p = ipow(du, degree - 1);
+        for (unsigned i = degree; i-- > 0;) {
+            d[i] = (float) (binomials[i] * (degree - i) / n * p);
+            p *= s;
+        }
+    }
+    for (unsigned i = degree; i > 0; --i)
+        d[i] = (float) (n * (d[i - 1] - d[i]));
+    d[0] = (float) (-n * d[0]);
+}
+
+/**
+ * Evaluate the curve of control points ctrl at u, Horner scheme in u / (1 - u) or (1 - u) / u
+ * @param ctrl degree + 1 control points
+ * @param u
+ * @return
+ */
+Point BernsteinBasis::Analytical(const Point *ctrl, const float &u) const {
+    double du = u;
+    double x, y, z, scale;
+    if (du <= 0.5) {
+        double t = du / (1 - du);
+        x = binomials[degree] * ctrl[degree].x;
+        y = binomials[degree] * ctrl[degree].y;
+        z = binomials[degree] * ctrl[degree].z;
+        for (unsigned i = degree; i-- > 0;) {
+            x = x * t + binomials[i] * ctrl[i].x;
+            y = y * t + binomials[i] * ctrl[i].y;
+            z = z * t + binomials[i] * ctrl[i].z;
+        }
+        scale = ipow(1 - du, degree);
+    } else {
+        double s = (1 - du) / du;
+        x = binomials[0] * ctrl[0].x;
+        y = binomials[0] * ctrl[0].y;
+        z = binomials[0] * ctrl[0].z;
+        for (unsigned i = 1; i <= degree; ++i) {
+            x = x * s + binomials[i] * ctrl[i].x;
+            y = y * s + binomials[i] * ctrl[i].y;
+            z = z * s + binomials[i] * ctrl[i].z;
+        }
+        scale = ipow(du, degree);
+    }
+    return Point((float) (x * scale), (float) (y * scale), (float) (z * scale));
+}
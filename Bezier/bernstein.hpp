@@ -0,0 +1,31 @@
+#pragma once
+
+#include "vec.h"
+#include <vector>
+
+/**
+ * Bernstein basis of any degree, binomials are generated once per degree in double precision.
+ * Evaluation is scaled so that no intermediate overflows or underflows : with t = u / (1 - u),
+ * B(i, n)(u) = C(n, i) (1 - u)^n t^i for u <= 1/2, and symmetrically with (1 - u) / u above,
+ * which also gives a Horner scheme for the curve points.
+ */
+class BernsteinBasis {
+private:
+    unsigned degree;
+    std::vector<double> binomials;
+
+public:
+    explicit BernsteinBasis(const unsigned &degree = 0);
+
+    unsigned getDegree() const { return degree; }
+
+    double binomial(const unsigned &i) const { return binomials[i]; }
+
+    void weights(const float &u, float *w) const;
+
+    void derivatives(const float &u, float *w, float *d) const;
+
+    Point Analytical(const Point *ctrl, const float &u) const;
+
+    static double ipow(double x, unsigned e);
+};
@@ -3,54 +3,134 @@
 #include "vec.h"
 #include "mat.h"
 #include "mesh.h"
+#include "arcLength.hpp"
+#include "bernstein.hpp"
+#include "bezierN.hpp"
+#include "curveBatch.hpp"
+#include "curveBounds.hpp"
+#include "curveIntersector.hpp"
+#include "curveProjector.hpp"
+#include "lazyValue.hpp"
+#include "samplingPlan.hpp"
 #include <utility>
 #include <vector>
 
+//Outcome of BezierCurve::CalculateCurvePointsAdaptive
+struct AdaptiveReport {
+    unsigned nbPoints;
+    //Largest flatness bound among the emitted spans, bounds the distance between curve and polyline
+    float chordError;
+};
+
+//Point of a curve with its first and second derivatives
+struct CurveSample {
+    vec3 position;
+    vec3 d1;
+    vec3 d2;
+};
+
 class BezierCurve {
 private:
     std::vector<Point> ctrlPts;
 
-    //For analytical calculations
-    const float cnp[16][16] = {
-            {1, 0,  0,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 1,  0,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 2,  1,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 3,  3,   1,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 4,  6,   4,   1,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 5,  10,  5,   1,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 6,  15,  20,  15,   6,    1,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 7,  21,  35,  35,   21,   7,    1,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 8,  28,  56,  70,   56,   28,   8,    1,    0,    0,    0,    0,   0,   0,  0},
-            {1, 9,  36,  84,  126,  126,  84,   36,   9,    1,    0,    0,    0,   0,   0,  0},
-            {1, 10, 45,  120, 210,  252,  210,  120,  45,   10,   1,    0,    0,   0,   0,  0},
-            {1, 11, 55,  165, 330,  462,  462,  330,  165,  55,   11,   1,    0,   0,   0,  0},
-            {1, 12, 66,  220, 495,  792,  924,  792,  495,  220,  66,   12,   1,   0,   0,  0},
-            {1, 13, 78,  268, 715,  1287, 1716, 1716, 1287, 715,  286,  78,   13,  1,   0,  0},
-            {1, 14, 91,  364, 1001, 2002, 3003, 3432, 3003, 2002, 1001, 364,  91,  14,  1,  0},
-            {1, 15, 105, 455, 1365, 3003, 5005, 6435, 6435, 5005, 3003, 1365, 455, 105, 15, 1},
-    };
-
-    std::vector<float> ui;
-    std::vector<float> uni;
-
-    float B(const unsigned &i, const unsigned &n);
-
-    void initU(const float &u);
+    //For analytical calculations, any degree
+    BernsteinBasis basis;
+
+    //SoA copy of ctrlPts used by the tessellation functions
+    CurveBatch batch;
+
+    //Arc length, bounds and power basis are invalidated when the control points change and rebuilt by the first
+    //const member that reads them, once even when several threads read the same curve
+    //Cumulative arc length
+    LazyValue<ArcLengthTable> arcLength;
+
+    //Exact bounds, minimum then maximum
+    LazyValue<std::pair<Point, Point>> bounds;
+
+    //Power basis coefficients, x then y then z rows of ctrlPts.size(), empty unless usePowerBasis is set
+    bool usePowerBasis = false;
+    LazyValue<std::vector<float>> power;
+
+    //Bernstein values at the parameters of the step tessellations, sampleBasis[i * nbSamples + k] = B_i(u_k)
+    float sampleStep = 0;
+    std::vector<float> sampleBasis;
+
+    const ArcLengthTable &arcLengthTable() const;
+
+    const std::vector<float> &powerCoefficients() const;
+
+    void invalidate();
+
+    void updateSampleBasis(const float &step);
+
+    static void sampleParams(std::vector<float> &params, const float &step);
+
+    void tessellate(const float *params, const unsigned &count, vec3 *out, float *scratch) const;
 
 public:
     explicit BezierCurve(std::vector<Point> ctrl);
 
     void changeCtrlPts(const std::vector<Point> &newPts);
 
-    vec3 Analytical(const float &u);
+    const std::vector<Point> &getCtrlPts() const { return ctrlPts; }
+
+    void moveCtrlPt(const unsigned &i, const Vector &delta);
+
+    void moveCtrlPt(const unsigned &i, const Vector &delta, std::vector<vec3> &curvePts, const float &step);
+
+    vec3 Analytical(const float &u) const;
 
     vec3 Casteljau(const float &u) const;
 
+    CurveSample Derivatives(const float &u) const;
+
+    void Derivatives(const std::vector<float> &u, std::vector<vec3> &pos, std::vector<vec3> &d1,
+                     std::vector<vec3> &d2) const;
+
+    float length() const;
+
+    float paramAtLength(const float &s) const;
+
+    void ClosestPoints(const std::vector<Point> &queries, std::vector<ClosestPoint> &out) const;
+
+    void Intersections(const BezierCurve &other, std::vector<CurveIntersection> &out) const;
+
+    void setPowerBasis(const bool &enable);
+
+    bool powerBasis() const { return usePowerBasis; }
+
+    vec3 Horner(const float &u) const;
+
     void CalculateCurvePointsCasteljau(std::vector<vec3> &curvePts, const float &step) const;
 
-    void CalculateCurvePointsAnalytical(std::vector<vec3> &curvePts, const float &step);
+    void CalculateCurvePointsCasteljau(std::vector<vec3> &curvePts, const SamplingPlan &plan) const;
+
+    void CalculateCurvePointsAnalytical(std::vector<vec3> &curvePts, const float &step) const;
+
+    void CalculateCurvePointsAnalytical(std::vector<vec3> &curvePts, const SamplingPlan &plan) const;
+
+    void CalculateCurvePointsArcLength(std::vector<vec3> &curvePts, const unsigned &nbPoints) const;
+
+    AdaptiveReport CalculateCurvePointsAdaptive(std::vector<vec3> &curvePts, const float &epsilon,
+                                                const unsigned &maxDepth = 16) const;
+
+    void CalculateCurvePointsForward(std::vector<vec3> &curvePts, const float &step, const unsigned &reanchor = 0) const;
+
+    static void tessellateBatch(const BezierCurve *curves, const unsigned &count, const float &step,
+                                std::vector<vec3> &out, std::vector<unsigned> &offsets);
+
+    static void tessellateBatch(const BezierCurve *curves, const unsigned &count, const SamplingPlan &plan,
+                                std::vector<vec3> &out, std::vector<unsigned> &offsets);
+
+    static void tessellateBatch(const std::vector<BezierCurve> &curves, const float &step, std::vector<vec3> &out,
+                                std::vector<unsigned> &offsets);
 
     void getBounds(Point &minPt, Point &maxPt) const;
 
+    static void getBounds(const std::vector<BezierCurve> &curves, std::vector<Point> &minPts,
+                          std::vector<Point> &maxPts);
+
     static Mesh makeSOR(const std::vector<vec3> &curvePts, const float &rotStep);
+
+    static Mesh makeSOR(const std::vector<vec3> &curvePts, const SamplingPlan &angles);
 };
\ No newline at end of file
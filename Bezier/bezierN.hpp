@@ -0,0 +1,204 @@
+#pragma once
+
+#include "vec.h"
+
+/**
+ * Degree specialized Bezier curves and patches : control points in fixed size arrays, binomials computed
+ * at compile time and Bernstein sums unrolled by template recursion, no loop or branch is left for the
+ * common degrees. Weights are float powers of u and 1 - u, while the generic BernsteinBasis evaluates in double
+ * with a Horner scheme, so the two are not bit-identical : on random nets they agree within (degree + 3) 2^-24
+ * times the largest control point coordinate.
+ */
+
+//Binomial coefficient C(n, k), evaluated by the compiler for the template degrees
+constexpr float binomialN(const unsigned n, const unsigned k) {
+    return k == 0 || k == n ? 1.f : binomialN(n - 1, k - 1) + binomialN(n - 1, k);
+}
+
+//x^E as the product 1 * x * x..., like the incremental power arrays of the generic evaluators
+template<unsigned E>
+struct PowN {
+    static float of(const float &x) { return PowN<E - 1>::of(x) * x; }
+};
+
+template<>
+struct PowN<0> {
+    static float of(const float &) { return 1.f; }
+};
+
+//Bernstein polynomials of degree D, terms 0 to I
+template<unsigned D, unsigned I>
+struct BernsteinN {
+    static constexpr float coeff = binomialN(D, I);
+
+    static void weights(const float &u, const float &u1, float *w) {
+        BernsteinN<D, I - 1>::weights(u, u1, w);
+        w[I] = coeff * PowN<I>::of(u) * PowN<D - I>::of(u1);
+    }
+
+    static void sum(const Point *p, const float *w, Point &pt) {
+        BernsteinN<D, I - 1>::sum(p, w, pt);
+        pt = pt + p[I] * w[I];
+    }
+
+    //Patch rows, each term also weighted by the row weight `outer`
+    static void sum(const Point *p, const float *w, const float &outer, Point &pt) {
+        BernsteinN<D, I - 1>::sum(p, w, outer, pt);
+        pt = pt + p[I] * outer * w[I];
+    }
+};
+
+template<unsigned D>
+struct BernsteinN<D, 0> {
+    static constexpr float coeff = 1.f;
+
+    static void weights(const float &u, const float &u1, float *w) {
+        w[0] = coeff * PowN<0>::of(u) * PowN<D>::of(u1);
+    }
+
+    static void sum(const Point *p, const float *w, Point &pt) {
+        pt = pt + p[0] * w[0];
+    }
+
+    static void sum(const Point *p, const float *w, const float &outer, Point &pt) {
+        pt = pt + p[0] * outer * w[0];
+    }
+};
+
+/**
+ * Bezier curve of degree D, D + 1 control points
+ */
+template<unsigned D>
+class BezierCurveN {
+private:
+    Point ctrlPts[D + 1];
+
+public:
+    static const unsigned DEGREE = D;
+
+    explicit BezierCurveN(const Point *ctrl) {
+        for (unsigned i = 0; i <= D; ++i)
+            ctrlPts[i] = ctrl[i];
+    }
+
+    Point Analytical(const float &u) const { return Analytical(ctrlPts, u); }
+
+    /**
+     * Evaluate the curve of control points ctrl at u
+     * @param ctrl D + 1 control points
+     * @param u
+     * @return
+     */
+    static Point Analytical(const Point *ctrl, const float &u) {
+        float w[D + 1];
+        BernsteinN<D, D>::weights(u, 1 - u, w);
+        Point pt(0, 0, 0);
+        BernsteinN<D, D>::sum(ctrl, w, pt);
+        return pt;
+    }
+};
+
+/**
+ * Bezier patch of degrees DU x DV, (DU + 1) rows of (DV + 1) control points
+ */
+template<unsigned DU, unsigned DV>
+class BezierPatchN {
+private:
+    Point ctrlPts[DU + 1][DV + 1];
+
+    template<unsigned I, bool = true>
+    struct Rows {
+        static void sum(const Point *const *rows, const float *wu, const float *wv, Point &pt) {
+            Rows<I - 1>::sum(rows, wu, wv, pt);
+            BernsteinN<DV, DV>::sum(rows[I], wv, wu[I], pt);
+        }
+    };
+
+    template<bool B>
+    struct Rows<0, B> {
+        static void sum(const Point *const *rows, const float *wu, const float *wv, Point &pt) {
+            BernsteinN<DV, DV>::sum(rows[0], wv, wu[0], pt);
+        }
+    };
+
+public:
+    static const unsigned DEGREE_U = DU;
+    static const unsigned DEGREE_V = DV;
+
+    explicit BezierPatchN(const Point *const *rows) {
+        for (unsigned i = 0; i <= DU; ++i)
+            for (unsigned j = 0; j <= DV; ++j)
+                ctrlPts[i][j] = rows[i][j];
+    }
+
+    Point Analytical(const float &u, const float &v) const {
+        const Point *rows[DU + 1];
+        for (unsigned i = 0; i <= DU; ++i)
+            rows[i] = ctrlPts[i];
+        return Analytical(rows, u, v);
+    }
+
+    /**
+     * Evaluate the patch of control rows `rows` at (u, v)
+     * @param rows DU + 1 pointers to DV + 1 control points
+     * @param u
+     * @param v
+     * @return
+     */
+    static Point Analytical(const Point *const *rows, const float &u, const float &v) {
+        float wu[DU + 1], wv[DV + 1];
+        BernsteinN<DU, DU>::weights(u, 1 - u, wu);
+        BernsteinN<DV, DV>::weights(v, 1 - v, wv);
+        Point pt(0, 0, 0);
+        Rows<DU>::sum(rows, wu, wv, pt);
+        return pt;
+    }
+};
+
+//Runtime dispatch for linear to quintic, the returned evaluators are null when no specialization matches
+typedef Point (*CurveEvaluatorN)(const Point *, const float &);
+
+typedef Point (*PatchEvaluatorN)(const Point *const *, const float &, const float &);
+
+/**
+ * @param nbCtrl Number of control points of the curve
+ * @return the specialized evaluator of this degree, or null
+ */
+inline CurveEvaluatorN curveEvaluatorN(const unsigned &nbCtrl) {
+    switch (nbCtrl) {
+        case 2: return &BezierCurveN<1>::Analytical;
+        case 3: return &BezierCurveN<2>::Analytical;
+        case 4: return &BezierCurveN<3>::Analytical;
+        case 5: return &BezierCurveN<4>::Analytical;
+        case 6: return &BezierCurveN<5>::Analytical;
+        default: return nullptr;
+    }
+}
+
+template<unsigned DU>
+inline PatchEvaluatorN patchEvaluatorN(const unsigned &nv) {
+    switch (nv) {
+        case 2: return &BezierPatchN<DU, 1>::Analytical;
+        case 3: return &BezierPatchN<DU, 2>::Analytical;
+        case 4: return &BezierPatchN<DU, 3>::Analytical;
+        case 5: return &BezierPatchN<DU, 4>::Analytical;
+        case 6: return &BezierPatchN<DU, 5>::Analytical;
+        default: return nullptr;
+    }
+}
+
+/**
+ * @param nu Number of rows of the control net
+ * @param nv Number of control points per row
+ * @return the specialized evaluator of these degrees, or null
+ */
+inline PatchEvaluatorN patchEvaluatorN(const unsigned &nu, const unsigned &nv) {
+    switch (nu) {
+        case 2: return patchEvaluatorN<1>(nv);
+        case 3: return patchEvaluatorN<2>(nv);
+        case 4: return patchEvaluatorN<3>(nv);
+        case 5: return patchEvaluatorN<4>(nv);
+        case 6: return patchEvaluatorN<5>(nv);
+        default: return nullptr;
+    }
+}
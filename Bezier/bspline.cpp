@@ -0,0 +1,346 @@
+#include "bspline.hpp"
+#include "pack.hpp"
+#include "samplingPlan.hpp"
+#include <algorithm>
+
+namespace {
+    //Degrees up to this one run on stack buffers, higher ones allocate
+    const unsigned STACK_DEGREE = 15;
+}
+
+/**
+ * Constructor, clamped uniform knots
+ * @param ctrl Control points
+ * @param degree Degree, lowered to ctrl.size() - 1 for short control polygons (the curve is then a Bezier curve)
+ */
+BSplineCurve::BSplineCurve(std::vector<Point> ctrl, const unsigned &degree) : requestedDegree(degree), degree(degree),
+                                                                              ctrlPts(std::move(ctrl)) {
+    init(std::vector<float>());
+}
+
+/**
+ * Constructor
+ * @param ctrl Control points
+ * @param degree Degree, lowered to ctrl.size() - 1 for short control polygons
+ * @param knots ctrl.size() + degree + 1 non decreasing knots, clamped uniform knots are used for other sizes
+ */
+BSplineCurve::BSplineCurve(std::vector<Point> ctrl, const unsigned &degree, const std::vector<float> &knots)
+        : requestedDegree(degree), degree(degree), ctrlPts(std::move(ctrl)) {
+    init(knots);
+}
+
+/**
+ * Clamp the requested degree, set the knots and the weights, build the homogeneous points
+ * @param newKnots Used when they match the number of control points and the degree
+ */
+void BSplineCurve::init(const std::vector<float> &newKnots) {
+    unsigned n = ctrlPts.size();
+    if (n == 0) {
+        degree = 0;
+        knots.clear();
+    } else {
+        degree = std::min(requestedDegree, n - 1);
+        uniform = newKnots.size() != n + degree + 1;
+        if (uniform)
+            uniformKnots(n, degree, knots);
+        else
+            knots = newKnots;
+    }
+    weights.resize(n, 1.f);
+    updateHomogeneous();
+}
+
+/**
+ * Clamped uniform knot vector : degree + 1 zeros, the uniform interior knots and degree + 1 ones
+ * @param nbCtrl Number of control points
+ * @param degree
+ * @param knots Filled with nbCtrl + degree + 1 knots
+ */
+void BSplineCurve::uniformKnots(const unsigned &nbCtrl, const unsigned &degree, std::vector<float> &knots) {
+    unsigned nbSpans = nbCtrl - degree;
+    knots.assign(nbCtrl + degree + 1, 0.f);
+    for (unsigned i = 1; i < nbSpans; ++i)
+        knots[degree + i] = float(i) / float(nbSpans);
+    for (unsigned i = nbCtrl; i < knots.size(); ++i)
+        knots[i] = 1.f;
+}
+
+/**
+ * Homogeneous SoA copy of the control points
+ */
+void BSplineCurve::updateHomogeneous() {
+    unsigned n = ctrlPts.size();
+    hx.resize(n);
+    hy.resize(n);
+    hz.resize(n);
+    hw.resize(n);
+    for (unsigned i = 0; i < n; ++i) {
+        hx[i] = ctrlPts[i].x * weights[i];
+        hy[i] = ctrlPts[i].y * weights[i];
+        hz[i] = ctrlPts[i].z * weights[i];
+        hw[i] = weights[i];
+    }
+}
+
+/**
+ * Change controls points, the knots are kept when their number does not change, replaced by clamped
+ * uniform knots otherwise (new control points then get a weight of 1) and the degree given to the constructor
+ * is clamped again to the new control points
+ * @param newPts New controls points
+ */
+void BSplineCurve::changeCtrlPts(const std::vector<Point> &newPts) {
+    bool keep = newPts.size() == ctrlPts.size();
+    ctrlPts = newPts;
+    if (keep)
+        updateHomogeneous();
+    else
+        init(std::vector<float>());
+}
+
+/**
+ * Knot span of u, O(1) for uniform knots and a binary search otherwise
+ * @param u Clamped to [domainMin(), domainMax()]
+ * @return the index s in [degree, ctrlPts.size() - 1] such that knots[s] <= u < knots[s + 1]
+ */
+unsigned BSplineCurve::findSpan(const float &u) const {
+    unsigned n = ctrlPts.size();
+    float lo = knots[degree], hi = knots[n];
+    float v = std::min(std::max(u, lo), hi);
+    if (uniform) {
+        unsigned s = unsigned((v - lo) / (hi - lo) * float(n - degree));
+        return degree + std::min(s, n - degree - 1);
+    }
+    return unsigned(std::upper_bound(knots.begin() + degree + 1, knots.begin() + n, v) - knots.begin()) - 1;
+}
+
+/**
+ * Cox-de Boor recurrence, the degree + 1 basis functions that are not zero in the span
+ * @param span findSpan(u)
+ * @param u
+ * @param N Filled with N(span - degree), ..., N(span)
+ */
+void BSplineCurve::basisFunctions(const unsigned &span, const float &u, float *N) const {
+    float stack[2 * (STACK_DEGREE + 1)];
+    std::vector<float> heap;
+    float *left = stack;
+    if (degree > STACK_DEGREE) {
+        heap.resize(2 * (degree + 1));
+        left = heap.data();
+    }
+    float *right = left + degree + 1;
+
+    N[0] = 1;
+    for (unsigned j = 1; j <= degree; ++j) {
+        left[j] = u - knots[span + 1 - j];
+        right[j] = knots[span + j] - u;
+        float saved = 0;
+        for (unsigned r = 0; r < j; ++r) {
+            float temp = N[r] / (right[r + 1] + left[j - r]);
+            N[r] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        N[j] = saved;
+    }
+}
+
+/**
+ * Evaluate the curve as the sum of the basis functions of the span times their control points
+ * @param u
+ * @return
+ */
+vec3 BSplineCurve::CoxDeBoor(const float &u) const {
+    if (ctrlPts.empty())
+        return vec3(0, 0, 0);
+    float stack[STACK_DEGREE + 1];
+    std::vector<float> heap;
+    float *N = stack;
+    if (degree > STACK_DEGREE) {
+        heap.resize(degree + 1);
+        N = heap.data();
+    }
+    unsigned span = findSpan(u);
+    basisFunctions(span, std::min(std::max(u, domainMin()), domainMax()), N);
+    float x = 0, y = 0, z = 0, w = 0;
+    for (unsigned j = 0; j <= degree; ++j) {
+        unsigned i = span - degree + j;
+        x += N[j] * hx[i];
+        y += N[j] * hy[i];
+        z += N[j] * hz[i];
+        w += N[j] * hw[i];
+    }
+    if (rational)
+        return vec3(x / w, y / w, z / w);
+    return vec3(x, y, z);
+}
+
+/**
+ * Evaluate the curve with de Boor's algorithm on the degree + 1 homogeneous control points of the span
+ * @param u
+ * @return
+ */
+vec3 BSplineCurve::DeBoor(const float &u) const {
+    if (ctrlPts.empty())
+        return vec3(0, 0, 0);
+    float stack[4 * (STACK_DEGREE + 1)];
+    std::vector<float> heap;
+    float *dx = stack;
+    if (degree > STACK_DEGREE) {
+        heap.resize(4 * (degree + 1));
+        dx = heap.data();
+    }
+    float *dy = dx + degree + 1, *dz = dy + degree + 1, *dw = dz + degree + 1;
+
+    unsigned span = findSpan(u);
+    float v = std::min(std::max(u, domainMin()), domainMax());
+    unsigned first = span - degree;
+    for (unsigned j = 0; j <= degree; ++j) {
+        dx[j] = hx[first + j];
+        dy[j] = hy[first + j];
+        dz[j] = hz[first + j];
+        dw[j] = hw[first + j];
+    }
+    for (unsigned r = 1; r <= degree; ++r)
+        for (unsigned j = degree; j >= r; --j) {
+            unsigned i = first + j;
+            float denom = knots[i + degree - r + 1] - knots[i];
+            float alpha = denom > 0 ? (v - knots[i]) / denom : 0.f;
+            float alpha1 = 1 - alpha;
+            dx[j] = dx[j - 1] * alpha1 + dx[j] * alpha;
+            dy[j] = dy[j - 1] * alpha1 + dy[j] * alpha;
+            dz[j] = dz[j - 1] * alpha1 + dz[j] * alpha;
+            dw[j] = dw[j - 1] * alpha1 + dw[j] * alpha;
+        }
+    if (rational)
+        return vec3(dx[degree] / dw[degree], dy[degree] / dw[degree], dz[degree] / dw[degree]);
+    return vec3(dx[degree], dy[degree], dz[degree]);
+}
+
+/**
+ * @return number of floats of scratch needed by Evaluate
+ */
+unsigned BSplineCurve::scratchSize() const {
+    return 4 * (degree + 1) * CurveBatch::LANES;
+}
+
+/**
+ * de Boor's algorithm on up to LANES parameters, with the same operations as DeBoor in each lane.
+ * Parameters spread over several spans are evaluated one by one
+ */
+void BSplineCurve::EvaluateBlock(const float *u, const unsigned &count, vec3 *out, float *scratch) const {
+    const unsigned L = CurveBatch::LANES;
+    unsigned span = findSpan(u[0]);
+    for (unsigned k = 1; k < count; ++k)
+        if (findSpan(u[k]) != span) {
+            for (unsigned l = 0; l < count; ++l)
+                out[l] = DeBoor(u[l]);
+            return;
+        }
+
+    float v[L];
+    float lo = domainMin(), hi = domainMax();
+    for (unsigned k = 0; k < L; ++k)
+        v[k] = std::min(std::max(u[k < count ? k : count - 1], lo), hi);
+    Pack pv = pload(v);
+
+    unsigned m = degree + 1;
+    float *dx = scratch, *dy = dx + m * L, *dz = dy + m * L, *dw = dz + m * L;
+    unsigned first = span - degree;
+    for (unsigned j = 0; j <= degree; ++j) {
+        pstore(dx + j * L, pset1(hx[first + j]));
+        pstore(dy + j * L, pset1(hy[first + j]));
+        pstore(dz + j * L, pset1(hz[first + j]));
+        pstore(dw + j * L, pset1(hw[first + j]));
+    }
+    for (unsigned r = 1; r <= degree; ++r)
+        for (unsigned j = degree; j >= r; --j) {
+            unsigned i = first + j;
+            float denom = knots[i + degree - r + 1] - knots[i];
+            Pack alpha = denom > 0 ? pdiv(psub(pv, pset1(knots[i])), pset1(denom)) : pset1(0.f);
+            Pack alpha1 = psub(pset1(1.f), alpha);
+            float *planes[4] = {dx, dy, dz, dw};
+            for (float *d: planes)
+                pstore(d + j * L, padd(pmul(pload(d + (j - 1) * L), alpha1), pmul(pload(d + j * L), alpha)));
+        }
+
+    float *x = dx + degree * L, *y = dy + degree * L, *z = dz + degree * L, *w = dw + degree * L;
+    for (unsigned k = 0; k < count; ++k)
+        out[k] = rational ? vec3(x[k] / w[k], y[k] / w[k], z[k] / w[k]) : vec3(x[k], y[k], z[k]);
+}
+
+/**
+ * Evaluate the curve at count parameters, by blocks of CurveBatch::LANES
+ * @param u
+ * @param count
+ * @param out count points
+ * @param scratch scratchSize() floats
+ */
+void BSplineCurve::Evaluate(const float *u, const unsigned &count, vec3 *out, float *scratch) const {
+    if (ctrlPts.empty()) {
+        for (unsigned k = 0; k < count; ++k)
+            out[k] = vec3(0, 0, 0);
+        return;
+    }
+    for (unsigned k = 0; k < count; k += CurveBatch::LANES) {
+        unsigned block = count - k < CurveBatch::LANES ? count - k : CurveBatch::LANES;
+        EvaluateBlock(u + k, block, out + k, scratch);
+    }
+}
+
+/**
+ * Evaluate the curve at each parameter of u
+ * @param u
+ * @param out Resized and filled with one point per parameter
+ */
+void BSplineCurve::Evaluate(const std::vector<float> &u, std::vector<vec3> &out) const {
+    out.resize(u.size());
+    if (u.empty())
+        return;
+    std::vector<float> scratch(scratchSize());
+    Evaluate(u.data(), u.size(), out.data(), scratch.data());
+}
+
+/**
+ * curvePts will be filled with the points of the curve domain at the samples of SamplingPlan::fromStep(step),
+ * scaled to the domain, both ends included
+ * @param curvePts Curve points
+ * @param step
+ */
+void BSplineCurve::CalculateCurvePoints(std::vector<vec3> &curvePts, const float &step) const {
+    std::vector<float> params;
+    SamplingPlan(SamplingPlan::fromStep(step).size(), domainMin(), domainMax()).params(params);
+    Evaluate(params, curvePts);
+}
+
+/**
+ * Constructor, clamped uniform knots
+ * @param ctrl Control points
+ * @param weights One positive weight per control point
+ * @param degree
+ */
+NurbsCurve::NurbsCurve(std::vector<Point> ctrl, const std::vector<float> &weights, const unsigned &degree)
+        : BSplineCurve(std::move(ctrl), degree) {
+    changeWeights(weights);
+}
+
+/**
+ * Constructor
+ * @param ctrl Control points
+ * @param weights One positive weight per control point
+ * @param degree
+ * @param knots ctrl.size() + degree + 1 non decreasing knots
+ */
+NurbsCurve::NurbsCurve(std::vector<Point> ctrl, const std::vector<float> &weights, const unsigned &degree,
+                       const std::vector<float> &knots) : BSplineCurve(std::move(ctrl), degree, knots) {
+    changeWeights(weights);
+}
+
+/**
+ * Change the weights
+ * @param newWeights One positive weight per control point, missing ones are 1
+ */
+void NurbsCurve::changeWeights(const std::vector<float> &newWeights) {
+    weights.assign(ctrlPts.size(), 1.f);
+    std::copy(newWeights.begin(), newWeights.begin() + std::min(newWeights.size(), weights.size()), weights.begin());
+    rational = true;
+    updateHomogeneous();
+}
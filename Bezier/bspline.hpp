@@ -0,0 +1,88 @@
+#pragma once
+
+#include "vec.h"
+#include <vector>
+
+/**
+ * B-spline curve of any degree : each point only depends on the degree + 1 control points of its knot span,
+ * so evaluation costs O(degree^2) whatever the number of control points and editing a control point only
+ * changes degree + 1 spans. The default knot vector is clamped uniform (the curve starts and ends on the
+ * end control points) and its spans are found in O(1), other knot vectors by binary search.
+ * Control points are also kept in homogeneous SoA form (x w, y w, z w, w) for the batched kernel, which runs
+ * de Boor's algorithm on CurveBatch::LANES parameters at once when they share a span.
+ */
+class BSplineCurve {
+protected:
+    //Degree asked by the caller, degree is it lowered to ctrlPts.size() - 1 for short control polygons
+    unsigned requestedDegree;
+    unsigned degree;
+    std::vector<Point> ctrlPts;
+    //One weight per control point, all 1 unless rational
+    std::vector<float> weights;
+    //ctrlPts.size() + degree + 1 non decreasing knots
+    std::vector<float> knots;
+    bool rational = false;
+    bool uniform = true;
+
+    std::vector<float> hx;
+    std::vector<float> hy;
+    std::vector<float> hz;
+    std::vector<float> hw;
+
+    void init(const std::vector<float> &newKnots);
+
+    void updateHomogeneous();
+
+    void EvaluateBlock(const float *u, const unsigned &count, vec3 *out, float *scratch) const;
+
+public:
+    BSplineCurve(std::vector<Point> ctrl, const unsigned &degree);
+
+    BSplineCurve(std::vector<Point> ctrl, const unsigned &degree, const std::vector<float> &knots);
+
+    void changeCtrlPts(const std::vector<Point> &newPts);
+
+    unsigned getDegree() const { return degree; }
+
+    const std::vector<float> &getKnots() const { return knots; }
+
+    const std::vector<Point> &getCtrlPts() const { return ctrlPts; }
+
+    float domainMin() const { return knots.empty() ? 0.f : knots[degree]; }
+
+    float domainMax() const { return knots.empty() ? 1.f : knots[ctrlPts.size()]; }
+
+    unsigned findSpan(const float &u) const;
+
+    void basisFunctions(const unsigned &span, const float &u, float *N) const;
+
+    vec3 CoxDeBoor(const float &u) const;
+
+    vec3 DeBoor(const float &u) const;
+
+    unsigned scratchSize() const;
+
+    void Evaluate(const float *u, const unsigned &count, vec3 *out, float *scratch) const;
+
+    void Evaluate(const std::vector<float> &u, std::vector<vec3> &out) const;
+
+    void CalculateCurvePoints(std::vector<vec3> &curvePts, const float &step) const;
+
+    static void uniformKnots(const unsigned &nbCtrl, const unsigned &degree, std::vector<float> &knots);
+};
+
+/**
+ * Rational B-spline : control point i pulls the curve with weight w_i > 0, points are evaluated on the
+ * homogeneous control points (w_i P_i, w_i) and projected back
+ */
+class NurbsCurve : public BSplineCurve {
+public:
+    NurbsCurve(std::vector<Point> ctrl, const std::vector<float> &weights, const unsigned &degree);
+
+    NurbsCurve(std::vector<Point> ctrl, const std::vector<float> &weights, const unsigned &degree,
+               const std::vector<float> &knots);
+
+    void changeWeights(const std::vector<float> &newWeights);
+
+    const std::vector<float> &getWeights() const { return weights; }
+};
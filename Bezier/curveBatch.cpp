@@ -0,0 +1,352 @@
+#include "curveBatch.hpp"
+#include "pack.hpp"
+#include <cassert>
+
+/**
+ * Constructor
+ * @param ctrl Controls points
+ */
+CurveBatch::CurveBatch(const std::vector<Point> &ctrl) {
+    changeCtrlPts(ctrl);
+}
+
+/**
+ * Change controls points, splits them in x/y/z planes and caches the binomial row of the degree, in float up to
+ * MAX_PACKED_SIZE points and as a BernsteinBasis above
+ * @param newPts New controls points
+ */
+void CurveBatch::changeCtrlPts(const std::vector<Point> &newPts) {
+    unsigned n = newPts.size();
+    xs.resize(n);
+    ys.resize(n);
+    zs.resize(n);
+    for (unsigned i = 0; i < n; ++i) {
+        xs[i] = newPts[i].x;
+        ys[i] = newPts[i].y;
+        zs[i] = newPts[i].z;
+    }
+
+    if (n > MAX_PACKED_SIZE) {
+        binomials.clear();
+        if (basis.getDegree() + 1 != n)
+            basis = BernsteinBasis(n - 1);
+        return;
+    }
+    binomials.assign(n, 1.f);
+    double c = 1;
+    for (unsigned k = 1; k < n; ++k) {
+        c = c * (n - k) / k;
+        binomials[k] = (float) c;
+    }
+}
+
+/**
+ * Change one control point in the planes, the degree and so the binomials stay the same
+ * @param i Index of the control point
+ * @param p New position
+ */
+void CurveBatch::setCtrlPt(const unsigned &i, const Point &p) {
+    assert(i < xs.size());
+    xs[i] = p.x;
+    ys[i] = p.y;
+    zs[i] = p.z;
+}
+
+/**
+ * @return number of floats the caller must provide as scratch to the pointer based evaluators
+ */
+unsigned CurveBatch::scratchSize() const {
+    return 3 * size() * LANES;
+}
+
+/**
+ * de Casteljau pyramid on one block of at most LANES parameters
+ * @param u
+ * @param scratch 3 * n * LANES floats
+ * @param out
+ * @param count
+ */
+void CurveBatch::CasteljauBlock(const float *u, float *scratch, vec3 *out, const unsigned &count) const {
+    unsigned n = size();
+    float *bx = scratch;
+    float *by = bx + n * LANES;
+    float *bz = by + n * LANES;
+
+    Pack pu = loadParams(u, count);
+    Pack pu1 = psub(pset1(1.f), pu);
+    for (unsigned j = 0; j < n; ++j) {
+        pstore(bx + j * LANES, pset1(xs[j]));
+        pstore(by + j * LANES, pset1(ys[j]));
+        pstore(bz + j * LANES, pset1(zs[j]));
+    }
+    for (unsigned i = 1; i < n; ++i) {
+        for (unsigned j = 0; j < n - i; ++j) {
+            float *x = bx + j * LANES;
+            float *y = by + j * LANES;
+            float *z = bz + j * LANES;
+            pstore(x, padd(pmul(pload(x), pu1), pmul(pload(x + LANES), pu)));
+            pstore(y, padd(pmul(pload(y), pu1), pmul(pload(y + LANES), pu)));
+            pstore(z, padd(pmul(pload(z), pu1), pmul(pload(z + LANES), pu)));
+        }
+    }
+    storePoints(pload(bx), pload(by), pload(bz), out, count);
+}
+
+/**
+ * Bernstein sum above MAX_PACKED_SIZE control points, with the scaled weights of BernsteinBasis summed in double
+ * @param u
+ * @param w n floats
+ * @param out
+ * @param count
+ */
+void CurveBatch::AnalyticalScaled(const float *u, float *w, vec3 *out, const unsigned &count) const {
+    unsigned n = size();
+    for (unsigned k = 0; k < count; ++k) {
+        basis.weights(u[k], w);
+        double x = 0, y = 0, z = 0;
+        for (unsigned i = 0; i < n; ++i) {
+            x += double(w[i]) * xs[i];
+            y += double(w[i]) * ys[i];
+            z += double(w[i]) * zs[i];
+        }
+        out[k] = vec3((float) x, (float) y, (float) z);
+    }
+}
+
+/**
+ * Bernstein sum on one block of at most LANES parameters
+ * @param u
+ * @param scratch n * LANES floats, holds the (1 - u)^k powers
+ * @param out
+ * @param count
+ */
+void CurveBatch::AnalyticalBlock(const float *u, float *scratch, vec3 *out, const unsigned &count) const {
+    unsigned n = size();
+    Pack pu = loadParams(u, count);
+    Pack pu1 = psub(pset1(1.f), pu);
+
+    float *uni = scratch;
+    Pack p = pset1(1.f);
+    pstore(uni, p);
+    for (unsigned k = 1; k < n; ++k) {
+        p = pmul(p, pu1);
+        pstore(uni + k * LANES, p);
+    }
+
+    Pack x = pset1(0.f), y = pset1(0.f), z = pset1(0.f);
+    Pack ui = pset1(1.f);
+    for (unsigned i = 0; i < n; ++i) {
+        Pack b = pmul(pmul(pset1(binomials[i]), ui), pload(uni + (n - 1 - i) * LANES));
+        x = padd(x, pmul(pset1(xs[i]), b));
+        y = padd(y, pmul(pset1(ys[i]), b));
+        z = padd(z, pmul(pset1(zs[i]), b));
+        ui = pmul(ui, pu);
+    }
+    storePoints(x, y, z, out, count);
+}
+
+/**
+ * de Casteljau pyramid on one block of at most LANES parameters, stopped three levels before the top :
+ * the last three points give the second derivative, the next two the first derivative and the position
+ * @param u
+ * @param scratch 3 * n * LANES floats
+ * @param pos
+ * @param d1
+ * @param d2
+ * @param count
+ */
+void CurveBatch::DerivativesBlock(const float *u, float *scratch, vec3 *pos, vec3 *d1, vec3 *d2,
+                                  const unsigned &count) const {
+    unsigned n = size();
+    float *bx = scratch;
+    float *by = bx + n * LANES;
+    float *bz = by + n * LANES;
+
+    Pack pu = loadParams(u, count);
+    Pack pu1 = psub(pset1(1.f), pu);
+    Pack zero = pset1(0.f);
+    if (n < 3) {
+        Pack x0 = pset1(n > 0 ? xs[0] : 0.f), y0 = pset1(n > 0 ? ys[0] : 0.f), z0 = pset1(n > 0 ? zs[0] : 0.f);
+        Pack x1 = n == 2 ? pset1(xs[1]) : x0, y1 = n == 2 ? pset1(ys[1]) : y0, z1 = n == 2 ? pset1(zs[1]) : z0;
+        if (n == 2)
+            storePoints(padd(pmul(x0, pu1), pmul(x1, pu)), padd(pmul(y0, pu1), pmul(y1, pu)),
+                        padd(pmul(z0, pu1), pmul(z1, pu)), pos, count);
+        else
+            storePoints(x0, y0, z0, pos, count);
+        storePoints(psub(x1, x0), psub(y1, y0), psub(z1, z0), d1, count);
+        storePoints(zero, zero, zero, d2, count);
+        return;
+    }
+
+    //The first level is computed from the control points, then the levels two by two : the sweep computes level
+    //i at j + 1 and level i + 1 at j from registers, so each point costs one load and one store per axis for two
+    //levels. The three axes are interleaved
+    for (unsigned j = 0; j + 1 < n; ++j) {
+        pstore(bx + j * LANES, padd(pmul(pset1(xs[j]), pu1), pmul(pset1(xs[j + 1]), pu)));
+        pstore(by + j * LANES, padd(pmul(pset1(ys[j]), pu1), pmul(pset1(ys[j + 1]), pu)));
+        pstore(bz + j * LANES, padd(pmul(pset1(zs[j]), pu1), pmul(pset1(zs[j + 1]), pu)));
+    }
+    unsigned i = 2;
+    for (; i + 3 < n; i += 2) {
+        //x : level i - 1 at j + 1, a : level i at j
+        Pack x = pload(bx + LANES), y = pload(by + LANES), z = pload(bz + LANES);
+        Pack ax = padd(pmul(pload(bx), pu1), pmul(x, pu));
+        Pack ay = padd(pmul(pload(by), pu1), pmul(y, pu));
+        Pack az = padd(pmul(pload(bz), pu1), pmul(z, pu));
+        for (unsigned j = 0; j + i + 1 < n; ++j) {
+            Pack nx = pload(bx + (j + 2) * LANES), ny = pload(by + (j + 2) * LANES), nz = pload(bz + (j + 2) * LANES);
+            Pack cx = padd(pmul(x, pu1), pmul(nx, pu));
+            Pack cy = padd(pmul(y, pu1), pmul(ny, pu));
+            Pack cz = padd(pmul(z, pu1), pmul(nz, pu));
+            pstore(bx + j * LANES, padd(pmul(ax, pu1), pmul(cx, pu)));
+            pstore(by + j * LANES, padd(pmul(ay, pu1), pmul(cy, pu)));
+            pstore(bz + j * LANES, padd(pmul(az, pu1), pmul(cz, pu)));
+            x = nx;
+            y = ny;
+            z = nz;
+            ax = cx;
+            ay = cy;
+            az = cz;
+        }
+    }
+    for (; i + 2 < n; ++i) {
+        Pack x = pload(bx), y = pload(by), z = pload(bz);
+        for (unsigned j = 0; j < n - i; ++j) {
+            Pack nx = pload(bx + (j + 1) * LANES), ny = pload(by + (j + 1) * LANES), nz = pload(bz + (j + 1) * LANES);
+            pstore(bx + j * LANES, padd(pmul(x, pu1), pmul(nx, pu)));
+            pstore(by + j * LANES, padd(pmul(y, pu1), pmul(ny, pu)));
+            pstore(bz + j * LANES, padd(pmul(z, pu1), pmul(nz, pu)));
+            x = nx;
+            y = ny;
+            z = nz;
+        }
+    }
+
+    //With 3 control points the first level is not computed, the last three points are the control points
+    float d = float(n - 1);
+    Pack deg1 = pset1(d), deg2 = pset1(d * (d - 1)), two = pset1(2.f);
+    Pack p[3], v1[3], v2[3];
+    const float *b[3] = {bx, by, bz};
+    const std::vector<float> *ctrl[3] = {&xs, &ys, &zs};
+    for (unsigned axis = 0; axis < 3; ++axis) {
+        Pack q0, q1, q2;
+        if (n == 3) {
+            q0 = pset1((*ctrl[axis])[0]);
+            q1 = pset1((*ctrl[axis])[1]);
+            q2 = pset1((*ctrl[axis])[2]);
+        } else {
+            q0 = pload(b[axis]);
+            q1 = pload(b[axis] + LANES);
+            q2 = pload(b[axis] + 2 * LANES);
+        }
+        v2[axis] = pmul(deg2, padd(psub(q0, pmul(two, q1)), q2));
+        Pack r0 = padd(pmul(q0, pu1), pmul(q1, pu));
+        Pack r1 = padd(pmul(q1, pu1), pmul(q2, pu));
+        v1[axis] = pmul(deg1, psub(r1, r0));
+        p[axis] = padd(pmul(r0, pu1), pmul(r1, pu));
+    }
+    storePoints(p[0], p[1], p[2], pos, count);
+    storePoints(v1[0], v1[1], v1[2], d1, count);
+    storePoints(v2[0], v2[1], v2[2], d2, count);
+}
+
+/**
+ * Evaluate the curve at `count` parameters with de Casteljau's method
+ * @param u Parameters
+ * @param count
+ * @param out Filled with `count` points
+ * @param scratch scratchSize() floats, lets callers share or reuse the working memory
+ */
+void CurveBatch::Casteljau(const float *u, const unsigned &count, vec3 *out, float *scratch) const {
+    if (size() == 0) {
+        for (unsigned k = 0; k < count; ++k)
+            out[k] = vec3(0, 0, 0);
+        return;
+    }
+    for (unsigned k = 0; k < count; k += LANES) {
+        unsigned block = count - k < LANES ? count - k : LANES;
+        CasteljauBlock(u + k, scratch, out + k, block);
+    }
+}
+
+/**
+ * Evaluate the curve at each parameter of u with de Casteljau's method
+ * @param u Parameters
+ * @param out Resized and filled with one point per parameter
+ */
+void CurveBatch::Casteljau(const std::vector<float> &u, std::vector<vec3> &out) const {
+    std::vector<float> scratch(scratchSize());
+    out.resize(u.size());
+    if (!u.empty())
+        Casteljau(u.data(), u.size(), out.data(), scratch.data());
+}
+
+/**
+ * Evaluate the curve at `count` parameters with the Bernstein polynomials
+ * @param u Parameters
+ * @param count
+ * @param out Filled with `count` points
+ * @param scratch scratchSize() floats
+ */
+void CurveBatch::Analytical(const float *u, const unsigned &count, vec3 *out, float *scratch) const {
+    if (size() == 0) {
+        for (unsigned k = 0; k < count; ++k)
+            out[k] = vec3(0, 0, 0);
+        return;
+    }
+    if (size() > MAX_PACKED_SIZE) {
+        AnalyticalScaled(u, scratch, out, count);
+        return;
+    }
+    for (unsigned k = 0; k < count; k += LANES) {
+        unsigned block = count - k < LANES ? count - k : LANES;
+        AnalyticalBlock(u + k, scratch, out + k, block);
+    }
+}
+
+/**
+ * Evaluate the curve at each parameter of u with the Bernstein polynomials
+ * @param u Parameters
+ * @param out Resized and filled with one point per parameter
+ */
+void CurveBatch::Analytical(const std::vector<float> &u, std::vector<vec3> &out) const {
+    std::vector<float> scratch(scratchSize());
+    out.resize(u.size());
+    if (!u.empty())
+        Analytical(u.data(), u.size(), out.data(), scratch.data());
+}
+
+/**
+ * Position, first and second derivatives of the curve at `count` parameters, from a single de Casteljau pyramid
+ * @param u Parameters
+ * @param count
+ * @param pos Filled with `count` points
+ * @param d1 Filled with `count` first derivatives
+ * @param d2 Filled with `count` second derivatives
+ * @param scratch scratchSize() floats
+ */
+void CurveBatch::Derivatives(const float *u, const unsigned &count, vec3 *pos, vec3 *d1, vec3 *d2,
+                             float *scratch) const {
+    if (size() == 0) {
+        for (unsigned k = 0; k < count; ++k)
+            pos[k] = d1[k] = d2[k] = vec3(0, 0, 0);
+        return;
+    }
+    for (unsigned k = 0; k < count; k += LANES) {
+        unsigned block = count - k < LANES ? count - k : LANES;
+        DerivativesBlock(u + k, scratch, pos + k, d1 + k, d2 + k, block);
+    }
+}
+
+/**
+ * @return name of the instruction set the kernels were compiled for
+ */
+const char *CurveBatch::isa() {
+#if defined(CURVE_BATCH_AVX2)
+    return "avx2";
+#elif defined(CURVE_BATCH_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vec.h"
+#include "bernstein.hpp"
+#include <vector>
+
+/**
+ * Batched evaluation of a Bezier curve, LANES parameter values per kernel call.
+ * Control points are kept in structure-of-arrays form (one plane per axis), the kernels use
+ * AVX2 or SSE when the compiler targets them and a plain scalar loop otherwise.
+ *
+ * Tolerance : the kernels perform the same multiplications and additions in the same order as
+ * BezierCurve::Casteljau / BezierCurve::Analytical, with separate mul and add instructions (no fma),
+ * so results are bit-identical to the scalar path as long as the compiler does not contract the
+ * scalar code into fma (-ffp-contract=off). When it does (gcc with -march=native on fma hardware),
+ * the difference stays below 2e-6 times the largest control point coordinate, up to 16 control points.
+ * CurveBatch::Analytical forms the same Bernstein products as BezierCurveN, so it matches
+ * BezierCurve::Analytical up to quintic curves; above, the scalar path is BernsteinBasis (double precision
+ * Horner) and the two differ by float rounding only.
+ * Above MAX_PACKED_SIZE control points the float binomials and powers of the packed Bernstein sum leave the float
+ * range, CurveBatch::Analytical then takes its weights from BernsteinBasis, one parameter at a time.
+ */
+class CurveBatch {
+private:
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<float> binomials;
+    //Weights above MAX_PACKED_SIZE control points
+    BernsteinBasis basis;
+
+    void CasteljauBlock(const float *u, float *scratch, vec3 *out, const unsigned &count) const;
+
+    void AnalyticalScaled(const float *u, float *w, vec3 *out, const unsigned &count) const;
+
+    void AnalyticalBlock(const float *u, float *scratch, vec3 *out, const unsigned &count) const;
+
+    void DerivativesBlock(const float *u, float *scratch, vec3 *pos, vec3 *d1, vec3 *d2, const unsigned &count) const;
+
+public:
+    //Number of parameter values evaluated per kernel call
+    static const unsigned LANES = 8;
+
+    //Largest number of control points of the packed Bernstein sum : C(99, 49) and 2^-99 stay well inside the float
+    //range, C(n - 1, k) overflows and u^k (1 - u)^(n - 1 - k) leaves the normal floats from about 128 points
+    static const unsigned MAX_PACKED_SIZE = 100;
+
+    CurveBatch() = default;
+
+    explicit CurveBatch(const std::vector<Point> &ctrl);
+
+    void changeCtrlPts(const std::vector<Point> &newPts);
+
+    void setCtrlPt(const unsigned &i, const Point &p);
+
+    unsigned size() const { return (unsigned) xs.size(); }
+
+    unsigned scratchSize() const;
+
+    void Casteljau(const float *u, const unsigned &count, vec3 *out, float *scratch) const;
+
+    void Casteljau(const std::vector<float> &u, std::vector<vec3> &out) const;
+
+    void Analytical(const float *u, const unsigned &count, vec3 *out, float *scratch) const;
+
+    void Analytical(const std::vector<float> &u, std::vector<vec3> &out) const;
+
+    void Derivatives(const float *u, const unsigned &count, vec3 *pos, vec3 *d1, vec3 *d2, float *scratch) const;
+
+    static const char *isa();
+};
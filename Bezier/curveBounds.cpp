@@ -0,0 +1,169 @@
+#include "curveBounds.hpp"
+#include "curveSubdivision.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //Split depth after which an interval still changing sign several times is reported as one root at its middle
+    const unsigned MAX_DEPTH = 30;
+
+    //Sign changes of the coefficients, zeros skipped
+    unsigned signChanges(const double *b, const unsigned &n) {
+        unsigned changes = 0;
+        int last = 0;
+        for (unsigned i = 0; i < n; ++i) {
+            int sign = b[i] > 0 ? 1 : (b[i] < 0 ? -1 : 0);
+            if (sign != 0) {
+                if (last != 0 && sign != last)
+                    ++changes;
+                last = sign;
+            }
+        }
+        return changes;
+    }
+
+    //Value at t of the polynomial of n Bernstein coefficients, tmp : n doubles
+    double evaluate(const double *b, const unsigned &n, const double &t, double *tmp) {
+        std::copy(b, b + n, tmp);
+        for (unsigned i = 1; i < n; ++i)
+            for (unsigned j = 0; j < n - i; ++j)
+                tmp[j] = tmp[j] * (1 - t) + tmp[j + 1] * t;
+        return tmp[0];
+    }
+
+    /**
+     * Roots in [u0, u1] of the polynomial of n Bernstein coefficients b (local parameter in [0, 1])
+     * @param work 2 n (MAX_DEPTH + 1) + n doubles
+     * @param out Filled with the roots
+     */
+    void roots(const double *b, const unsigned &n, const double &u0, const double &u1, const unsigned &depth,
+               double *work, std::vector<float> &out) {
+        unsigned changes = signChanges(b, n);
+        if (changes == 0)
+            return;
+        double *tmp = work + 2 * n * (MAX_DEPTH + 1);
+        if (changes == 1 && b[0] != 0 && b[n - 1] != 0) {
+            //Regula falsi, Illinois variant
+            double a = 0, c = 1, fa = b[0], fc = b[n - 1], t = 0.5;
+            int side = 0;
+            for (unsigned it = 0; it < 60 && c - a > 1e-12; ++it) {
+                t = (a * fc - c * fa) / (fc - fa);
+                double ft = evaluate(b, n, t, tmp);
+                if (ft == 0)
+                    break;
+                if ((ft > 0) == (fc > 0)) {
+                    c = t;
+                    fc = ft;
+                    if (side == -1) fa *= 0.5;
+                    side = -1;
+                } else {
+                    a = t;
+                    fa = ft;
+                    if (side == 1) fc *= 0.5;
+                    side = 1;
+                }
+            }
+            out.push_back(float(u0 + (u1 - u0) * t));
+            return;
+        }
+        double um = 0.5 * (u0 + u1);
+        if (depth >= MAX_DEPTH) {
+            out.push_back(float(um));
+            return;
+        }
+        double *left = work + 2 * n * depth, *right = left + n;
+        splitHalf(b, n, left, right);
+        //right[0] is the value at the middle
+        if (right[0] == 0)
+            out.push_back(float(um));
+        roots(left, n, u0, um, depth + 1, work, out);
+        roots(right, n, um, u1, depth + 1, work, out);
+    }
+
+    //de Casteljau in double, so that the extrema are not moved by float rounding, tmp : n doubles
+    Point casteljau(const Point *ctrl, const unsigned &n, const float &u, double *tmp) {
+        Point p;
+        for (unsigned axis = 0; axis < 3; ++axis) {
+            for (unsigned i = 0; i < n; ++i)
+                tmp[i] = ctrl[i](axis);
+            for (unsigned i = 1; i < n; ++i)
+                for (unsigned j = 0; j < n - i; ++j)
+                    tmp[j] = tmp[j] * (1 - double(u)) + tmp[j + 1] * double(u);
+            p(axis) = (float) tmp[0];
+        }
+        return p;
+    }
+}
+
+/**
+ * Bounds of the control points, they contain the curve
+ * @param ctrl
+ * @param n Number of control points, at least 1
+ * @param pmin
+ * @param pmax
+ */
+void controlBounds(const Point *ctrl, const unsigned &n, Point &pmin, Point &pmax) {
+    pmin = ctrl[0];
+    pmax = ctrl[0];
+    for (unsigned i = 1; i < n; ++i) {
+        pmin = min(pmin, ctrl[i]);
+        pmax = max(pmax, ctrl[i]);
+    }
+}
+
+/**
+ * Exact bounds of the curve, both set to the origin for an empty curve
+ * @param ctrl
+ * @param n Number of control points
+ * @param pmin
+ * @param pmax
+ */
+void curveBounds(const Point *ctrl, const unsigned &n, Point &pmin, Point &pmax) {
+    if (n == 0) {
+        pmin = pmax = Point(0, 0, 0);
+        return;
+    }
+    pmin = min(ctrl[0], ctrl[n - 1]);
+    pmax = max(ctrl[0], ctrl[n - 1]);
+    if (n < 3)
+        return;
+
+    //Early out : inner control points already inside the end points box
+    bool inside = true;
+    for (unsigned i = 1; i + 1 < n && inside; ++i)
+        for (unsigned axis = 0; axis < 3; ++axis)
+            inside = inside && ctrl[i](axis) >= pmin(axis) && ctrl[i](axis) <= pmax(axis);
+    if (inside)
+        return;
+
+    unsigned m = n - 1;
+    std::vector<double> derivative(m), work(2 * m * (MAX_DEPTH + 1) + m);
+    std::vector<float> params;
+    for (unsigned axis = 0; axis < 3; ++axis) {
+        for (unsigned i = 0; i < m; ++i)
+            derivative[i] = double(ctrl[i + 1](axis)) - double(ctrl[i](axis));
+        roots(derivative.data(), m, 0., 1., 0, work.data(), params);
+    }
+
+    std::vector<double> tmp(n);
+    for (const float &u: params) {
+        Point p = casteljau(ctrl, n, u, tmp.data());
+        pmin = min(pmin, p);
+        pmax = max(pmax, p);
+    }
+}
+
+/**
+ * Exact bounds of an array of curves, spread over the OpenMP threads
+ * @param curves Control points of each curve
+ * @param pmin Resized and filled with one minimum per curve
+ * @param pmax Resized and filled with one maximum per curve
+ */
+void curveBounds(const std::vector<std::vector<Point>> &curves, std::vector<Point> &pmin, std::vector<Point> &pmax) {
+    pmin.resize(curves.size());
+    pmax.resize(curves.size());
+    int count = (int) curves.size();
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int k = 0; k < count; ++k)
+        curveBounds(curves[k].data(), curves[k].size(), pmin[k], pmax[k]);
+}
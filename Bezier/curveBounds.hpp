@@ -0,0 +1,17 @@
+#pragma once
+
+#include "vec.h"
+#include <vector>
+
+/**
+ * Exact axis aligned bounds of Bezier curves : the extrema of each coordinate lie at the curve end points
+ * or at the roots of its derivative. The derivative is kept in Bernstein form (hodograph coordinates, in
+ * double), intervals are split in half until their coefficients change sign at most once (variation
+ * diminishing property), and single roots are refined by regula falsi.
+ */
+
+void curveBounds(const Point *ctrl, const unsigned &n, Point &pmin, Point &pmax);
+
+void curveBounds(const std::vector<std::vector<Point>> &curves, std::vector<Point> &pmin, std::vector<Point> &pmax);
+
+void controlBounds(const Point *ctrl, const unsigned &n, Point &pmin, Point &pmax);
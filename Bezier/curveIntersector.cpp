@@ -0,0 +1,275 @@
+#include "curveIntersector.hpp"
+#include "curveBounds.hpp"
+#include "curveSubdivision.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    bool overlap(const Point &amin, const Point &amax, const Point &bmin, const Point &bmax, const float &margin) {
+        return amin.x <= bmax.x + margin && bmin.x <= amax.x + margin && amin.y <= bmax.y + margin &&
+               bmin.y <= amax.y + margin && amin.z <= bmax.z + margin && bmin.z <= amax.z + margin;
+    }
+
+    float clamp01(const float &x) {
+        return std::min(1.f, std::max(0.f, x));
+    }
+
+    /**
+     * Closest points of the segments [p1, q1] and [p2, q2]
+     * @param s Parameter of the closest point on the first segment
+     * @param t Parameter of the closest point on the second segment
+     * @return their distance
+     */
+    float segmentDistance(const Point &p1, const Point &q1, const Point &p2, const Point &q2, float &s, float &t) {
+        Vector d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        float a = length2(d1), e = length2(d2), f = dot(d2, r);
+        if (a <= 0 && e <= 0) {
+            s = t = 0;
+        } else if (a <= 0) {
+            s = 0;
+            t = clamp01(f / e);
+        } else {
+            float c = dot(d1, r);
+            if (e <= 0) {
+                t = 0;
+                s = clamp01(-c / a);
+            } else {
+                float b = dot(d1, d2);
+                float denom = a * e - b * b;
+                s = denom > 0 ? clamp01((b * f - c * e) / denom) : 0.f;
+                t = (b * s + f) / e;
+                if (t < 0) {
+                    t = 0;
+                    s = clamp01(-c / a);
+                } else if (t > 1) {
+                    t = 1;
+                    s = clamp01((b - c) / a);
+                }
+            }
+        }
+        return distance(p1 + d1 * s, p2 + d2 * t);
+    }
+
+    /**
+     * Point and tangent of the curve of n control points at t, de Casteljau pyramid stopped two points from the top
+     * @param tmp n points of scratch
+     */
+    void evaluate(const Point *ctrl, const unsigned &n, const float &t, Point *tmp, Point &p, Vector &d1) {
+        if (n < 2) {
+            p = ctrl[0];
+            d1 = Vector(0, 0, 0);
+            return;
+        }
+        std::copy(ctrl, ctrl + n, tmp);
+        float t1 = 1 - t;
+        for (unsigned i = 1; i + 1 < n; ++i)
+            for (unsigned j = 0; j < n - i; ++j)
+                tmp[j] = tmp[j] * t1 + tmp[j + 1] * t;
+        d1 = (tmp[1] - tmp[0]) * float(n - 1);
+        p = tmp[0] * t1 + tmp[1] * t;
+    }
+}
+
+//State of the intersection of one pair of curves
+struct CurveIntersector::Pair {
+    unsigned na;
+    unsigned nb;
+    float absTolerance;
+    float absFlatness;
+    //Sub-curves of each depth : two halves of a then two halves of b
+    std::vector<Point> buffer;
+    std::vector<Point> tmpA;
+    std::vector<Point> tmpB;
+    std::vector<CurveIntersection> hits;
+};
+
+/**
+ * Constructor
+ * @param tolerance Largest distance between the curves at an intersection, relative to the pair extent
+ * @param flatness Flatness of the sub-curves handed to Newton iterations, relative to the pair extent
+ * @param maxDepth Subdivision depth limit
+ */
+CurveIntersector::CurveIntersector(const float &tolerance, const float &flatness, const unsigned &maxDepth)
+        : tolerance(tolerance), flatness(flatness), maxDepth(maxDepth) {
+}
+
+/**
+ * Intersections of the sub-curves a of [ua0, ua1] and b of [vb0, vb1]
+ */
+void CurveIntersector::subdivide(Pair &pair, const Point *a, const float &ua0, const float &ua1, const Point *b,
+                                 const float &vb0, const float &vb1, const unsigned &depth) const {
+    Point amin, amax, bmin, bmax;
+    controlBounds(a, pair.na, amin, amax);
+    controlBounds(b, pair.nb, bmin, bmax);
+    if (!overlap(amin, amax, bmin, bmax, pair.absTolerance))
+        return;
+
+    float fa = hullFlatness(a, pair.na), fb = hullFlatness(b, pair.nb);
+    bool splitA = fa > pair.absFlatness, splitB = fb > pair.absFlatness;
+    if ((!splitA && !splitB) || depth >= maxDepth) {
+        float s, t;
+        if (segmentDistance(a[0], a[pair.na - 1], b[0], b[pair.nb - 1], s, t) <= fa + fb + pair.absTolerance)
+            solve(pair, a, ua0, ua1, b, vb0, vb1);
+        return;
+    }
+
+    Point *aL = &pair.buffer[depth * 2 * (pair.na + pair.nb)];
+    Point *aR = aL + pair.na, *bL = aR + pair.na, *bR = bL + pair.nb;
+    float ua = 0.5f * (ua0 + ua1), vb = 0.5f * (vb0 + vb1);
+    if (splitA)
+        splitHalf(a, pair.na, aL, aR);
+    if (splitB)
+        splitHalf(b, pair.nb, bL, bR);
+    if (splitA && splitB) {
+        subdivide(pair, aL, ua0, ua, bL, vb0, vb, depth + 1);
+        subdivide(pair, aL, ua0, ua, bR, vb, vb1, depth + 1);
+        subdivide(pair, aR, ua, ua1, bL, vb0, vb, depth + 1);
+        subdivide(pair, aR, ua, ua1, bR, vb, vb1, depth + 1);
+    } else if (splitA) {
+        subdivide(pair, aL, ua0, ua, b, vb0, vb1, depth + 1);
+        subdivide(pair, aR, ua, ua1, b, vb0, vb1, depth + 1);
+    } else {
+        subdivide(pair, a, ua0, ua1, bL, vb0, vb, depth + 1);
+        subdivide(pair, a, ua0, ua1, bR, vb, vb1, depth + 1);
+    }
+}
+
+/**
+ * Gauss-Newton iterations on F(s, t) = a(s) - b(t) from the closest points of the chords,
+ * (J^T J) delta = -J^T F with J = [a'(s), -b'(t)]. Keeps the hit when the curves meet within tolerance
+ */
+void CurveIntersector::solve(Pair &pair, const Point *a, const float &ua0, const float &ua1, const Point *b,
+                             const float &vb0, const float &vb1) const {
+    float s, t;
+    segmentDistance(a[0], a[pair.na - 1], b[0], b[pair.nb - 1], s, t);
+    Point pa, pb;
+    Vector da, db;
+    for (unsigned it = 0; it < 10; ++it) {
+        evaluate(a, pair.na, s, pair.tmpA.data(), pa, da);
+        evaluate(b, pair.nb, t, pair.tmpB.data(), pb, db);
+        Vector f = pa - pb;
+        float a11 = dot(da, da), a12 = -dot(da, db), a22 = dot(db, db);
+        float r1 = dot(da, f), r2 = -dot(db, f);
+        float det = a11 * a22 - a12 * a12;
+        //Parallel tangents, the chords start is kept
+        if (!(det > 1e-12f * a11 * a22))
+            break;
+        float ds = -(a22 * r1 - a12 * r2) / det, dt = -(a11 * r2 - a12 * r1) / det;
+        float ns = clamp01(s + ds), nt = clamp01(t + dt);
+        bool done = std::abs(ns - s) + std::abs(nt - t) < 1e-7f;
+        s = ns;
+        t = nt;
+        if (done)
+            break;
+    }
+    evaluate(a, pair.na, s, pair.tmpA.data(), pa, da);
+    evaluate(b, pair.nb, t, pair.tmpB.data(), pb, db);
+    if (distance(pa, pb) > pair.absTolerance)
+        return;
+
+    CurveIntersection hit;
+    hit.u = ua0 + (ua1 - ua0) * s;
+    hit.v = vb0 + (vb1 - vb0) * t;
+    hit.point = vec3(center(pa, pb));
+    pair.hits.push_back(hit);
+}
+
+/**
+ * Intersections of two curves, sorted by u
+ * @param a Control points of the first curve
+ * @param b Control points of the second curve
+ * @param out Filled with the intersections
+ */
+void CurveIntersector::intersect(const std::vector<Point> &a, const std::vector<Point> &b,
+                                 std::vector<CurveIntersection> &out) const {
+    out.clear();
+    if (a.empty() || b.empty())
+        return;
+
+    Pair pair;
+    pair.na = a.size();
+    pair.nb = b.size();
+    Point amin, amax, bmin, bmax;
+    controlBounds(a.data(), pair.na, amin, amax);
+    controlBounds(b.data(), pair.nb, bmin, bmax);
+    float extent = distance(min(amin, bmin), max(amax, bmax));
+    pair.absTolerance = tolerance * extent;
+    pair.absFlatness = flatness * extent;
+    pair.buffer.resize((maxDepth + 1) * 2 * (pair.na + pair.nb));
+    pair.tmpA.resize(pair.na);
+    pair.tmpB.resize(pair.nb);
+    subdivide(pair, a.data(), 0.f, 1.f, b.data(), 0.f, 1.f, 0);
+
+    std::sort(pair.hits.begin(), pair.hits.end(), [](const CurveIntersection &l, const CurveIntersection &r) {
+        return l.u < r.u || (l.u == r.u && l.v < r.v);
+    });
+    for (const CurveIntersection &hit: pair.hits) {
+        if (!out.empty() && distance(Point(out.back().point), Point(hit.point)) <= pair.absFlatness)
+            continue;
+        out.push_back(hit);
+    }
+}
+
+/**
+ * Pairs of curves whose exact bounds (curveBounds) overlap, sweep along x over the boxes sorted by their minimum
+ * @param curves Control points of each curve
+ * @param pairs Filled with the candidate pairs (first < second)
+ */
+void CurveIntersector::candidatePairs(const std::vector<std::vector<Point>> &curves,
+                                      std::vector<std::pair<unsigned, unsigned>> &pairs) {
+    pairs.clear();
+    std::vector<Point> pmin, pmax;
+    curveBounds(curves, pmin, pmax);
+    std::vector<unsigned> order;
+    for (unsigned i = 0; i < curves.size(); ++i)
+        if (!curves[i].empty())
+            order.push_back(i);
+    std::sort(order.begin(), order.end(), [&pmin](const unsigned &l, const unsigned &r) {
+        return pmin[l].x < pmin[r].x;
+    });
+    for (unsigned k = 0; k < order.size(); ++k) {
+        unsigned i = order[k];
+        for (unsigned l = k + 1; l < order.size() && pmin[order[l]].x <= pmax[i].x; ++l) {
+            unsigned j = order[l];
+            if (overlap(pmin[i], pmax[i], pmin[j], pmax[j], 0.f))
+                pairs.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+        }
+    }
+}
+
+/**
+ * All the intersections between the curves of a set, candidate pairs from candidatePairs intersected
+ * in parallel, sorted by first curve, second curve and u
+ * @param curves Control points of each curve
+ * @param out Filled with the intersections
+ */
+void CurveIntersector::intersect(const std::vector<std::vector<Point>> &curves,
+                                 std::vector<CurvePairIntersection> &out) const {
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    candidatePairs(curves, pairs);
+    out.clear();
+    int count = (int) pairs.size();
+#pragma omp parallel
+    {
+        std::vector<CurvePairIntersection> local;
+        std::vector<CurveIntersection> hits;
+#pragma omp for schedule(dynamic, 16) nowait
+        for (int k = 0; k < count; ++k) {
+            intersect(curves[pairs[k].first], curves[pairs[k].second], hits);
+            for (const CurveIntersection &hit: hits) {
+                CurvePairIntersection h;
+                h.first = pairs[k].first;
+                h.second = pairs[k].second;
+                h.hit = hit;
+                local.push_back(h);
+            }
+        }
+#pragma omp critical
+        out.insert(out.end(), local.begin(), local.end());
+    }
+    std::sort(out.begin(), out.end(), [](const CurvePairIntersection &l, const CurvePairIntersection &r) {
+        if (l.first != r.first) return l.first < r.first;
+        if (l.second != r.second) return l.second < r.second;
+        return l.hit.u < r.hit.u;
+    });
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "vec.h"
+#include <utility>
+#include <vector>
+
+//Intersection of two curves, at u on the first one and v on the second one
+struct CurveIntersection {
+    float u;
+    float v;
+    vec3 point;
+};
+
+//Intersection between the curves first and second of a set
+struct CurvePairIntersection {
+    unsigned first;
+    unsigned second;
+    CurveIntersection hit;
+};
+
+/**
+ * Curve / curve intersections by subdivision. Pairs of sub-curves whose control point boxes overlap are split
+ * in half with de Casteljau's method until both are within flatness of their chords; the chords then give a
+ * starting point for Gauss-Newton iterations on A(u) - B(v) = 0, kept when the curves meet within tolerance.
+ * Sub-curves whose chords are farther apart than their flatness plus the tolerance are discarded without
+ * iterating. Hits closer than the flatness, found twice on both sides of a split, are merged.
+ * For a set of curves, a sweep along x over the exact curve bounds selects the candidate pairs, which are
+ * then intersected in an OpenMP parallel loop.
+ * Tolerances are relative to the diagonal of the boxes of the pair, tangential contacts stop at maxDepth and
+ * overlapping curves report one hit per flat span.
+ */
+class CurveIntersector {
+private:
+    float tolerance;
+    float flatness;
+    unsigned maxDepth;
+
+    struct Pair;
+
+    void subdivide(Pair &pair, const Point *a, const float &ua0, const float &ua1, const Point *b,
+                   const float &vb0, const float &vb1, const unsigned &depth) const;
+
+    void solve(Pair &pair, const Point *a, const float &ua0, const float &ua1, const Point *b,
+               const float &vb0, const float &vb1) const;
+
+public:
+    /**
+     * @param tolerance Largest distance between the curves at an intersection, relative to the pair extent
+     * @param flatness Flatness of the sub-curves handed to Newton iterations, relative to the pair extent
+     * @param maxDepth Subdivision depth limit
+     */
+    explicit CurveIntersector(const float &tolerance = 1e-5f, const float &flatness = 1e-3f,
+                              const unsigned &maxDepth = 24);
+
+    void intersect(const std::vector<Point> &a, const std::vector<Point> &b, std::vector<CurveIntersection> &out) const;
+
+    void intersect(const std::vector<std::vector<Point>> &curves, std::vector<CurvePairIntersection> &out) const;
+
+    static void candidatePairs(const std::vector<std::vector<Point>> &curves,
+                               std::vector<std::pair<unsigned, unsigned>> &pairs);
+};
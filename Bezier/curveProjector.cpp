@@ -0,0 +1,283 @@
+#include "curveProjector.hpp"
+#include "curveSubdivision.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    //Squared distance from q to the box
+    float boxDistance2(const Point &q, const Point &pmin, const Point &pmax) {
+        float dx = std::max(0.f, std::max(pmin.x - q.x, q.x - pmax.x));
+        float dy = std::max(0.f, std::max(pmin.y - q.y, q.y - pmax.y));
+        float dz = std::max(0.f, std::max(pmin.z - q.z, q.z - pmax.z));
+        return dx * dx + dy * dy + dz * dz;
+    }
+}
+
+/**
+ * Constructor, builds the tree
+ * @param ctrl Control points of the curve
+ */
+CurveProjector::CurveProjector(const std::vector<Point> &ctrl) {
+    changeCtrlPts(ctrl);
+}
+
+/**
+ * Rebuild the tree for new control points. Sub-curves are leaves once their control points are within
+ * LEAF_FLATNESS of their own bounding box diagonal from their chord, or at MAX_DEPTH
+ * @param ctrl Control points of the curve
+ */
+void CurveProjector::changeCtrlPts(const std::vector<Point> &ctrl) {
+    //Leaves are this flat relative to their size : Newton starts close to the root and the chord bounds prune well
+    const float LEAF_FLATNESS = 0.05f;
+    nbCtrl = ctrl.size();
+    nodes.clear();
+    leafPts.clear();
+    leafCoefs.clear();
+    if (ctrl.empty())
+        return;
+
+    binomials.assign(3 * nbCtrl, 0.f);
+    for (unsigned row = 0; row < 3 && row < nbCtrl; ++row) {
+        unsigned degree = nbCtrl - 1 - row;
+        float *b = &binomials[row * nbCtrl];
+        b[0] = 1;
+        for (unsigned k = 1; k <= degree; ++k)
+            b[k] = b[k - 1] * float(degree - k + 1) / float(k);
+    }
+
+    nodes.resize(1);
+    build(0, ctrl.data(), 0.f, 1.f, 0, LEAF_FLATNESS);
+}
+
+/**
+ * Fill node index with the sub-curve ctrl of [u0, u1], and its children
+ * @param index
+ * @param ctrl nbCtrl control points
+ * @param u0
+ * @param u1
+ * @param depth
+ * @param tolerance Flatness of the leaves, relative to their bounding box diagonal
+ */
+void CurveProjector::build(const unsigned &index, const Point *ctrl, const float &u0, const float &u1,
+                           const unsigned &depth, const float &tolerance) {
+    Node node;
+    node.pmin = ctrl[0];
+    node.pmax = ctrl[0];
+    for (unsigned i = 1; i < nbCtrl; ++i) {
+        node.pmin = min(node.pmin, ctrl[i]);
+        node.pmax = max(node.pmax, ctrl[i]);
+    }
+    node.u0 = u0;
+    node.u1 = u1;
+    node.child = 0;
+    node.pts = 0;
+    node.flat = nbCtrl < 3 ? 0.f : hullFlatness(ctrl, nbCtrl);
+
+    if (depth >= MAX_DEPTH || node.flat <= tolerance * distance(node.pmin, node.pmax)) {
+        node.pts = leafPts.size();
+        leafPts.insert(leafPts.end(), ctrl, ctrl + nbCtrl);
+        //Scaled differences of the leaf for evaluate, rows of nbCtrl
+        unsigned d = nbCtrl - 1;
+        leafCoefs.resize(leafCoefs.size() + 3 * nbCtrl, Vector(0, 0, 0));
+        Vector *c = &leafCoefs[3 * node.pts];
+        const float *b0 = &binomials[0], *b1 = &binomials[nbCtrl], *b2 = &binomials[2 * nbCtrl];
+        for (unsigned i = 0; i <= d; ++i) {
+            c[i] = Vector(ctrl[i]) * b0[i];
+            if (i < d)
+                c[nbCtrl + i] = (ctrl[i + 1] - ctrl[i]) * b1[i];
+            if (i + 1 < d)
+                c[2 * nbCtrl + i] = ((ctrl[i + 2] - ctrl[i + 1]) - (ctrl[i + 1] - ctrl[i])) * b2[i];
+        }
+        nodes[index] = node;
+        return;
+    }
+
+    std::vector<Point> left(nbCtrl), right(nbCtrl);
+    splitHalf(ctrl, nbCtrl, left.data(), right.data());
+    node.child = nodes.size();
+    nodes[index] = node;
+    nodes.resize(nodes.size() + 2);
+    float mid = 0.5f * (u0 + u1);
+    build(node.child, left.data(), u0, mid, depth + 1, tolerance);
+    build(node.child + 1, right.data(), mid, u1, depth + 1, tolerance);
+}
+
+/**
+ * Point, first and second derivatives of a leaf sub-curve at t. With Q the control points (reversed when
+ * t > 1/2, x = min(t, 1 - t)) and s = x / (1 - x) :
+ * C = (1 - x)^d sum C(d, i) s^i Q_i, C' = d (1 - x)^(d - 1) sum C(d - 1, i) s^i (Q_i+1 - Q_i) and
+ * C'' = d (d - 1) (1 - x)^(d - 2) sum C(d - 2, i) s^i (Q_i+2 - 2 Q_i+1 + Q_i), each sum by Horner's rule.
+ * The binomials are symmetric and reversing Q reverses its differences, negated for the first ones which cancels
+ * dx/dt = -1, so both halves read the same precomputed rows, backward for t <= 1/2 and forward above
+ * @param coefs 3 rows of nbCtrl scaled differences of the leaf
+ * @param t
+ * @param p
+ * @param d1
+ * @param d2
+ */
+void CurveProjector::evaluate(const Vector *coefs, const float &t, Point &p, Vector &d1, Vector &d2) const {
+    unsigned d = nbCtrl - 1;
+    d1 = Vector(0, 0, 0);
+    d2 = Vector(0, 0, 0);
+    if (d == 0) {
+        p = Point(coefs[0]);
+        return;
+    }
+    bool flip = t > 0.5f;
+    float x = flip ? 1 - t : t;
+    float y = 1 - x;
+    float s = x / y;
+    const Vector *c0 = coefs, *c1 = coefs + nbCtrl, *c2 = coefs + 2 * nbCtrl;
+
+    //Component-wise, the loops stay free of the out of line Vector operators
+    float a0[3] = {0, 0, 0}, a1[3] = {0, 0, 0}, a2[3] = {0, 0, 0};
+    for (unsigned k = 0; k <= d; ++k) {
+        unsigned i = flip ? k : d - k;
+        a0[0] = a0[0] * s + c0[i].x;
+        a0[1] = a0[1] * s + c0[i].y;
+        a0[2] = a0[2] * s + c0[i].z;
+    }
+    for (unsigned k = 0; k < d; ++k) {
+        unsigned i = flip ? k : d - 1 - k;
+        a1[0] = a1[0] * s + c1[i].x;
+        a1[1] = a1[1] * s + c1[i].y;
+        a1[2] = a1[2] * s + c1[i].z;
+    }
+    for (unsigned k = 0; k + 1 < d; ++k) {
+        unsigned i = flip ? k : d - 2 - k;
+        a2[0] = a2[0] * s + c2[i].x;
+        a2[1] = a2[1] * s + c2[i].y;
+        a2[2] = a2[2] * s + c2[i].z;
+    }
+
+    //(1 - x)^(d - 2), (1 - x)^(d - 1), (1 - x)^d
+    float w2 = 1;
+    for (unsigned k = 2; k < d; ++k)
+        w2 *= y;
+    float w1 = d >= 2 ? w2 * y : 1.f;
+    float w0 = w1 * y;
+    float k1 = float(d) * w1, k2 = float(d) * float(d - 1) * w2;
+    p = Point(a0[0] * w0, a0[1] * w0, a0[2] * w0);
+    d1 = Vector(a1[0] * k1, a1[1] * k1, a1[2] * k1);
+    if (d >= 2)
+        d2 = Vector(a2[0] * k2, a2[1] * k2, a2[2] * k2);
+}
+
+/**
+ * Closest point of a leaf sub-curve, updates best when nearer. The start is the projection on the nearest
+ * edge of the control polygon, then Newton iterations on f(t) = (C(t) - q).C'(t), f'(t) = C'.C' + (C - q).C''
+ * @param leaf
+ * @param q
+ * @param best
+ */
+void CurveProjector::refine(const Node &leaf, const Point &q, ClosestPoint &best) const {
+    const Point *ctrl = &leafPts[leaf.pts];
+    const Vector *coefs = &leafCoefs[3 * leaf.pts];
+    unsigned d = nbCtrl - 1;
+
+    //Component-wise, this loop runs on every refined leaf
+    float t = 0, edgeBest = distance2(q, ctrl[0]);
+    for (unsigned i = 0; i < d; ++i) {
+        float ex = ctrl[i + 1].x - ctrl[i].x, ey = ctrl[i + 1].y - ctrl[i].y, ez = ctrl[i + 1].z - ctrl[i].z;
+        float qx = q.x - ctrl[i].x, qy = q.y - ctrl[i].y, qz = q.z - ctrl[i].z;
+        float l2 = ex * ex + ey * ey + ez * ez;
+        float s = l2 > 0 ? std::min(1.f, std::max(0.f, (qx * ex + qy * ey + qz * ez) / l2)) : 0.f;
+        float rx = qx - ex * s, ry = qy - ey * s, rz = qz - ez * s;
+        float d2 = rx * rx + ry * ry + rz * rz;
+        if (d2 < edgeBest) {
+            edgeBest = d2;
+            t = (float(i) + s) / float(d);
+        }
+    }
+
+    //Stop once a step moves the point by less than this fraction of the leaf, the distance then changes by its
+    //square only
+    const float STEP_TOLERANCE = 1e-4f;
+    float minStep = STEP_TOLERANCE * distance(leaf.pmin, leaf.pmax);
+    Point p;
+    Vector d1, d2;
+    bool current = false;
+    for (unsigned it = 0; it < 8; ++it) {
+        evaluate(coefs, t, p, d1, d2);
+        current = true;
+        Vector r = p - q;
+        float f = dot(r, d1);
+        float fp = dot(d1, d1) + dot(r, d2);
+        if (fp <= 0)
+            break;
+        float next = std::min(1.f, std::max(0.f, t - f / fp));
+        if (std::abs(next - t) * length(d1) <= minStep)
+            break;
+        t = next;
+        current = false;
+    }
+    if (!current)
+        evaluate(coefs, t, p, d1, d2);
+
+    //The sub-curve end points are curve points too
+    float candidates[3] = {distance2(q, p), distance2(q, ctrl[0]), distance2(q, ctrl[d])};
+    Point pts[3] = {p, ctrl[0], ctrl[d]};
+    float ts[3] = {t, 0.f, 1.f};
+    for (unsigned k = 0; k < 3; ++k) {
+        float dist = std::sqrt(candidates[k]);
+        if (dist < best.distance) {
+            best.distance = dist;
+            best.point = vec3(pts[k]);
+            best.u = leaf.u0 + (leaf.u1 - leaf.u0) * ts[k];
+        }
+    }
+}
+
+/**
+ * @param q
+ * @return the closest point of the curve to q
+ */
+ClosestPoint CurveProjector::closest(const Point &q) const {
+    ClosestPoint best;
+    if (nodes.empty()) {
+        best.u = 0;
+        best.point = vec3(0, 0, 0);
+        best.distance = 0;
+        return best;
+    }
+    best.u = 0;
+    best.point = vec3(leafPts[0]);
+    best.distance = distance(q, leafPts[0]);
+
+    //Depth first, nearest child first, one pending sibling per level
+    unsigned stack[2 * MAX_DEPTH + 2];
+    unsigned top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node &node = nodes[stack[--top]];
+        if (boxDistance2(q, node.pmin, node.pmax) >= best.distance * best.distance)
+            continue;
+        if (node.child == 0) {
+            //Lower bound of the leaf distance : the leaf is within flat of its chord, and inside its box
+            const Point &a = leafPts[node.pts], &b = leafPts[node.pts + nbCtrl - 1];
+            float lower = std::max(std::sqrt(boxDistance2(q, node.pmin, node.pmax)),
+                                   distanceToSegment(q, a, b) - node.flat);
+            if (lower < best.distance)
+                refine(node, q, best);
+            continue;
+        }
+        const Node &a = nodes[node.child], &b = nodes[node.child + 1];
+        bool aFirst = boxDistance2(q, a.pmin, a.pmax) <= boxDistance2(q, b.pmin, b.pmax);
+        stack[top++] = aFirst ? node.child + 1 : node.child;
+        stack[top++] = aFirst ? node.child : node.child + 1;
+    }
+    return best;
+}
+
+/**
+ * Batched queries, spread over the OpenMP threads
+ * @param queries
+ * @param out Resized and filled with one result per query
+ */
+void CurveProjector::closest(const std::vector<Point> &queries, std::vector<ClosestPoint> &out) const {
+    out.resize(queries.size());
+    int count = (int) queries.size();
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int k = 0; k < count; ++k)
+        out[k] = closest(queries[k]);
+}
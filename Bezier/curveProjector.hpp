@@ -0,0 +1,70 @@
+#pragma once
+
+#include "vec.h"
+#include <vector>
+
+//Result of a closest point query
+struct ClosestPoint {
+    float u;
+    vec3 point;
+    float distance;
+};
+
+/**
+ * Closest point queries against a Bezier curve. The curve is split in half with de Casteljau's method until
+ * the sub-curves are flat relative to their own size, the bounding boxes of their control points form a binary
+ * tree (the curve lies in the convex hull of its control points, so the boxes bound it). A query visits the
+ * nearest boxes first, skips the ones farther than its best candidate, as well as the leaves whose lower bound
+ * (box distance, chord distance minus flatness) reaches it, and refines the projection on the control polygon
+ * of each remaining leaf with Newton iterations on (C(u) - q).C'(u) = 0, stopped when a step moves the point by
+ * a small fraction of the leaf. Leaves are evaluated with a scaled Horner scheme on their precomputed
+ * differences, linear in the number of control points.
+ * Queries are const and may run concurrently, the batched query is parallelized with OpenMP.
+ */
+class CurveProjector {
+private:
+    struct Node {
+        Point pmin;
+        Point pmax;
+        float u0;
+        float u1;
+        //Index of the first of the two children, 0 for leaves (the root is never a child)
+        unsigned child;
+        //Offset of the leaf sub-curve control points in leafPts
+        unsigned pts;
+        //Largest distance of the leaf sub-curve to its chord
+        float flat;
+    };
+
+    unsigned nbCtrl = 0;
+    std::vector<Node> nodes;
+    std::vector<Point> leafPts;
+    //3 * nbCtrl per leaf from 3 * pts : C(d, i) Q_i, C(d - 1, i) (Q_i+1 - Q_i), C(d - 2, i) (Q_i+2 - 2 Q_i+1 + Q_i)
+    std::vector<Vector> leafCoefs;
+
+    //Binomial rows of the degrees d, d - 1 and d - 2, nbCtrl floats each
+    std::vector<float> binomials;
+
+    void build(const unsigned &index, const Point *ctrl, const float &u0, const float &u1, const unsigned &depth,
+               const float &tolerance);
+
+    void evaluate(const Vector *coefs, const float &t, Point &p, Vector &d1, Vector &d2) const;
+
+    void refine(const Node &leaf, const Point &q, ClosestPoint &best) const;
+
+public:
+    //Subdivision stops at this depth even if the sub-curve is not flat
+    static const unsigned MAX_DEPTH = 10;
+
+    CurveProjector() = default;
+
+    explicit CurveProjector(const std::vector<Point> &ctrl);
+
+    void changeCtrlPts(const std::vector<Point> &ctrl);
+
+    unsigned nbLeaves() const { return nbCtrl ? (unsigned) leafPts.size() / nbCtrl : 0; }
+
+    ClosestPoint closest(const Point &q) const;
+
+    void closest(const std::vector<Point> &queries, std::vector<ClosestPoint> &out) const;
+};
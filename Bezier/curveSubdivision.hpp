@@ -0,0 +1,50 @@
+#pragma once
+
+#include "vec.h"
+#include <algorithm>
+
+/**
+ * Control polygon helpers shared by the subdivision algorithms on curves : adaptive tessellation, closest point
+ * tree, curve/curve intersection and bounds root isolation
+ */
+
+//Distance from p to the segment [a, b]
+inline float distanceToSegment(const Point &p, const Point &a, const Point &b) {
+    Vector ab = b - a;
+    float l2 = length2(ab);
+    float t = l2 > 0 ? std::min(1.f, std::max(0.f, dot(p - a, ab) / l2)) : 0.f;
+    return distance(p, a + ab * t);
+}
+
+//Largest distance of the n control points to the chord, bounds the distance of the curve to it
+inline float hullFlatness(const Point *ctrl, const unsigned &n) {
+    float err = 0;
+    for (unsigned i = 1; i + 1 < n; ++i)
+        err = std::max(err, distanceToSegment(ctrl[i], ctrl[0], ctrl[n - 1]));
+    return err;
+}
+
+inline Point midpoint(const Point &a, const Point &b) {
+    return center(a, b);
+}
+
+inline double midpoint(const double &a, const double &b) {
+    return 0.5 * (a + b);
+}
+
+/**
+ * Split the curve of n control points, or Bernstein coefficients, at 1/2. The de Casteljau pyramid is computed
+ * in place in right : the last point of each level is never overwritten again, so right ends up with the second
+ * half
+ * @param left Filled with the n control points of the first half
+ * @param right Filled with the n control points of the second half
+ */
+template<typename T>
+void splitHalf(const T *ctrl, const unsigned &n, T *left, T *right) {
+    std::copy(ctrl, ctrl + n, right);
+    for (unsigned i = 0; i < n; ++i) {
+        left[i] = right[0];
+        for (unsigned j = 0; j + 1 < n - i; ++j)
+            right[j] = midpoint(right[j], right[j + 1]);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+/**
+ * Value computed on first use after an invalidation, safe to read from const members running on several threads :
+ * the first reader rebuilds it under a lock, the others wait for it, then every reader only pays an atomic load.
+ * Invalidating is a change of the owner and must not run concurrently with readers.
+ * Copies start invalid, the owner rebuilds them from its own state.
+ */
+template<class T>
+class LazyValue {
+private:
+    mutable std::atomic<bool> valid;
+    mutable std::mutex mutex;
+    mutable T value;
+
+public:
+    LazyValue() : valid(false) {}
+
+    LazyValue(const LazyValue &) : valid(false) {}
+
+    LazyValue &operator=(const LazyValue &) {
+        invalidate();
+        return *this;
+    }
+
+    void invalidate() { valid.store(false, std::memory_order_release); }
+
+    /**
+     * @param build Called as build(value) to rebuild the value when it is invalid
+     * @return the value
+     */
+    template<class Build>
+    const T &get(const Build &build) const {
+        if (!valid.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!valid.load(std::memory_order_relaxed)) {
+                build(value);
+                valid.store(true, std::memory_order_release);
+            }
+        }
+        return value;
+    }
+};
@@ -10,13 +10,15 @@
 #include "bezier.hpp"
 #include "surface2D.hpp"
 #include "deformation.hpp"
+#include "patchModel.hpp"
+#include "patchSetTessellator.hpp"
 
 class CurveApp : public App {
 public:
     // constructeur : donner les dimensions de l'image, et eventuellement la version d'openGL.
-    CurveApp(const std::vector<Point> &ctrlPts, const std::vector<std::vector<Point>> &pts) : App(1024, 640),
-                                                                                              m_camera(), bc(ctrlPts),
-                                                                                              bs(pts) {
+    CurveApp(const std::vector<Point> &ctrlPts, const std::vector<std::vector<Point>> &pts,
+             std::vector<BezierSurface> modelPatches = {}) : App(1024, 640), m_camera(), bc(ctrlPts), bs(pts),
+                                                             patches(std::move(modelPatches)) {
         // projection par defaut, adaptee a la fenetre
         m_camera.projection(window_width(), window_height(), 45);
     }
@@ -37,11 +39,18 @@ public:
         //Surface Calculation
         // Choose one
         //bs.CalculateSurfacePointsCasteljau(surfacePoints, precision, precision);
-        bs.CalculateSurfacePointsAnalytical(surfacePoints, precision, precision);
+        //bs.CalculateSurfacePointsAnalytical(surfacePoints, precision, precision);
+        bs.CalculateSurfaceFramesAnalytical(surfacePoints, surfaceNormals, precision, precision);
 
         //Surface mesh generation or SOR mesh generation, choose one
-        m_mesh = BezierSurface::genMesh(surfacePoints);
+        m_mesh = BezierSurface::genMesh(surfacePoints, surfaceNormals);
         //m_mesh = BezierCurve::makeSOR(curvePoints, 5);
+
+        //Patch model given on the command line, replaces the surface
+        if (!patches.empty()) {
+            m_mesh = Mesh(GL_TRIANGLES);
+            PatchSetTessellator(precision).tessellate(patches, m_mesh);
+        }
         
         
         //Deformations Will aply
@@ -81,16 +90,16 @@ public:
         for (unsigned int i = 0; i < sizeU-1; ++i) {
             for (unsigned int j = 0; j < sizeV-1; ++j) {
                 
-                ids.emplace_back(i * sizeU + j);
-                ids.emplace_back(i * sizeU + j + 1);
-                ids.emplace_back(i * sizeU + j);
-                ids.emplace_back((i + 1) * sizeU + j);
-                ids.emplace_back((i + 1) * sizeU + j);
-                ids.emplace_back((i + 1) * sizeU + j +1);
-                ids.emplace_back((i + 1) * sizeU + j +1);
-                ids.emplace_back(i * sizeU + j + 1);
-                ids.emplace_back(i * sizeU + j + 1);
-                ids.emplace_back((i + 1) * sizeU + j);
+                ids.emplace_back(i * sizeV + j);
+                ids.emplace_back(i * sizeV + j + 1);
+                ids.emplace_back(i * sizeV + j);
+                ids.emplace_back((i + 1) * sizeV + j);
+                ids.emplace_back((i + 1) * sizeV + j);
+                ids.emplace_back((i + 1) * sizeV + j +1);
+                ids.emplace_back((i + 1) * sizeV + j +1);
+                ids.emplace_back(i * sizeV + j + 1);
+                ids.emplace_back(i * sizeV + j + 1);
+                ids.emplace_back((i + 1) * sizeV + j);
             }
         }
 
@@ -177,8 +186,10 @@ protected:
     GLuint vao{}, m_program_wireframe{};
     std::vector<vec3> curvePoints;
     std::vector<std::vector<vec3>> surfacePoints;
+    std::vector<std::vector<vec3>> surfaceNormals;
     BezierCurve bc;
     BezierSurface bs;
+    std::vector<BezierSurface> patches;
 
     std::vector<vec3> m_curve;
     std::vector<unsigned int> ids;
@@ -199,7 +210,17 @@ int main(int argc, char **argv) {
             {Point(9, 0, 0), Point(9, 0, 1), Point(9, 0, 2), Point(9, 0, 3)}
     };
 
-    CurveApp curveApp(ctrlPts, surfacePts);
+    //Optional patch model, text or binary, see PatchModel
+    PatchModel model;
+    if (argc > 1) {
+        PatchModelReport report;
+        if (!model.load(argv[1], &report))
+            return 1;
+        printf("%u patches loaded in %.3f ms, %.0f patches/s\n", report.nbPatches, report.readMs + report.parseMs,
+               report.patchesPerSecond);
+    }
+
+    CurveApp curveApp(ctrlPts, surfacePts, model.surfaces());
     curveApp.run();
 
     return 0;
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "curveBatch.hpp"
+#include <cmath>
+
+/**
+ * SIMD packs of CurveBatch::LANES floats for the batched kernels : AVX2 or SSE when the compiler targets them,
+ * a plain array otherwise. Only included by the kernel sources.
+ * ploada is pload for data of an AlignedFloats at a multiple of LANES floats, such as the padded planes and tables.
+ */
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CURVE_BATCH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CURVE_BATCH_SSE
+#endif
+
+//One pack holds CurveBatch::LANES floats, the kernels below are written once against these helpers
+#if defined(CURVE_BATCH_AVX2)
+struct Pack {
+    __m256 v;
+};
+
+inline Pack pset1(const float &a) { return {_mm256_set1_ps(a)}; }
+
+inline Pack pload(const float *p) { return {_mm256_loadu_ps(p)}; }
+
+//p 32 bytes aligned
+inline Pack ploada(const float *p) { return {_mm256_load_ps(p)}; }
+
+inline void pstore(float *p, const Pack &a) { _mm256_storeu_ps(p, a.v); }
+
+inline Pack padd(const Pack &a, const Pack &b) { return {_mm256_add_ps(a.v, b.v)}; }
+
+inline Pack psub(const Pack &a, const Pack &b) { return {_mm256_sub_ps(a.v, b.v)}; }
+
+inline Pack pmul(const Pack &a, const Pack &b) { return {_mm256_mul_ps(a.v, b.v)}; }
+
+inline Pack pdiv(const Pack &a, const Pack &b) { return {_mm256_div_ps(a.v, b.v)}; }
+
+inline Pack pmax(const Pack &a, const Pack &b) { return {_mm256_max_ps(a.v, b.v)}; }
+
+inline Pack psqrt(const Pack &a) { return {_mm256_sqrt_ps(a.v)}; }
+
+#elif defined(CURVE_BATCH_SSE)
+struct Pack {
+    __m128 lo, hi;
+};
+
+inline Pack pset1(const float &a) { return {_mm_set1_ps(a), _mm_set1_ps(a)}; }
+
+inline Pack pload(const float *p) { return {_mm_loadu_ps(p), _mm_loadu_ps(p + 4)}; }
+
+//p 16 bytes aligned
+inline Pack ploada(const float *p) { return {_mm_load_ps(p), _mm_load_ps(p + 4)}; }
+
+inline void pstore(float *p, const Pack &a) {
+    _mm_storeu_ps(p, a.lo);
+    _mm_storeu_ps(p + 4, a.hi);
+}
+
+inline Pack padd(const Pack &a, const Pack &b) { return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)}; }
+
+inline Pack psub(const Pack &a, const Pack &b) { return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)}; }
+
+inline Pack pmul(const Pack &a, const Pack &b) { return {_mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi)}; }
+
+inline Pack pdiv(const Pack &a, const Pack &b) { return {_mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi)}; }
+
+inline Pack pmax(const Pack &a, const Pack &b) { return {_mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi)}; }
+
+inline Pack psqrt(const Pack &a) { return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)}; }
+
+#else
+struct Pack {
+    float v[CurveBatch::LANES];
+};
+
+inline Pack pset1(const float &a) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a;
+    return r;
+}
+
+inline Pack pload(const float *p) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = p[k];
+    return r;
+}
+
+inline Pack ploada(const float *p) { return pload(p); }
+
+inline void pstore(float *p, const Pack &a) {
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) p[k] = a.v[k];
+}
+
+inline Pack padd(const Pack &a, const Pack &b) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a.v[k] + b.v[k];
+    return r;
+}
+
+inline Pack psub(const Pack &a, const Pack &b) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a.v[k] - b.v[k];
+    return r;
+}
+
+inline Pack pmul(const Pack &a, const Pack &b) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a.v[k] * b.v[k];
+    return r;
+}
+
+inline Pack pdiv(const Pack &a, const Pack &b) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a.v[k] / b.v[k];
+    return r;
+}
+
+inline Pack pmax(const Pack &a, const Pack &b) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = a.v[k] > b.v[k] ? a.v[k] : b.v[k];
+    return r;
+}
+
+inline Pack psqrt(const Pack &a) {
+    Pack r;
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k) r.v[k] = std::sqrt(a.v[k]);
+    return r;
+}
+
+#endif
+
+/**
+ * Load up to LANES parameters, the missing lanes repeat the last one
+ * @param u
+ * @param count
+ * @return
+ */
+inline Pack loadParams(const float *u, const unsigned &count) {
+    if (count == CurveBatch::LANES)
+        return pload(u);
+    float tmp[CurveBatch::LANES];
+    for (unsigned k = 0; k < CurveBatch::LANES; ++k)
+        tmp[k] = u[k < count ? k : count - 1];
+    return pload(tmp);
+}
+
+/**
+ * Write the first `count` lanes of (x, y, z) to out
+ */
+inline void storePoints(const Pack &x, const Pack &y, const Pack &z, vec3 *out, const unsigned &count) {
+    float tx[CurveBatch::LANES], ty[CurveBatch::LANES], tz[CurveBatch::LANES];
+    pstore(tx, x);
+    pstore(ty, y);
+    pstore(tz, z);
+    for (unsigned k = 0; k < count; ++k)
+        out[k] = vec3(tx[k], ty[k], tz[k]);
+}
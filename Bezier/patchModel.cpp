@@ -0,0 +1,385 @@
+#include "patchModel.hpp"
+#include "surface2D.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const char BINARY_MAGIC[4] = {'B', 'P', 'T', 'B'};
+    const uint32_t BINARY_VERSION = 1;
+    //Bytes of text per chunk of the parallel tokenizer
+    const std::size_t CHUNK = 1 << 18;
+
+    static_assert(sizeof(Point) == 3 * sizeof(float), "points are read and written as 3 floats");
+
+    double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool isBlank(const char &c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool isDigit(const char &c) {
+        return c >= '0' && c <= '9';
+    }
+
+    //Skip whitespace, line breaks and comments
+    const char *skipBlank(const char *ptr, const char *end) {
+        while (ptr < end) {
+            if (*ptr == '#')
+                while (ptr < end && *ptr != '\n')
+                    ++ptr;
+            else if (isBlank(*ptr))
+                ++ptr;
+            else
+                break;
+        }
+        return ptr;
+    }
+
+    /**
+     * Number starting at ptr, as parse_float of wavefront_fast.cpp with the end of the buffer checked : sign,
+     * digits, fraction, exponent, accumulated in double
+     * @param ptr
+     * @param end
+     * @param val
+     * @return Character after the number, nullptr if there is no digit or the number is not followed by a blank
+     */
+    const char *parseFloat(const char *ptr, const char *end, float *val) {
+        static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+                                        1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19};
+        double sign = 1;
+        if (ptr < end && (*ptr == '+' || *ptr == '-'))
+            sign = *ptr++ == '-' ? -1 : 1;
+        double num = 0;
+        bool digits = false;
+        while (ptr < end && isDigit(*ptr)) {
+            num = 10 * num + (*ptr++ - '0');
+            digits = true;
+        }
+        if (ptr < end && *ptr == '.') {
+            ++ptr;
+            double fra = 0, div = 1;
+            while (ptr < end && isDigit(*ptr)) {
+                fra = 10 * fra + (*ptr++ - '0');
+                div *= 10;
+                digits = true;
+            }
+            num += fra / div;
+        }
+        if (!digits)
+            return nullptr;
+        if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+            ++ptr;
+            bool negative = false;
+            if (ptr < end && (*ptr == '+' || *ptr == '-'))
+                negative = *ptr++ == '-';
+            unsigned e = 0;
+            while (ptr < end && isDigit(*ptr))
+                e = std::min(10 * e + (*ptr++ - '0'), 1000u);
+            double scale = 1;
+            for (; e >= 19; e -= 19)
+                scale *= POWERS[19];
+            scale *= POWERS[e];
+            num = negative ? num / scale : num * scale;
+        }
+        if (ptr < end && !isBlank(*ptr) && *ptr != '#')
+            return nullptr;
+        *val = (float) (sign * num);
+        return ptr;
+    }
+
+    //Count stored as a number of the text, false if it is not an integer of [0, max]. Compared in double :
+    //float(max) rounds up to 2^32 for the largest counts, which does not convert to unsigned
+    bool toCount(const float &value, const unsigned &max, unsigned &count) {
+        if (!(value >= 0 && double(value) <= double(max)) || value != float(unsigned(value)))
+            return false;
+        count = unsigned(value);
+        return true;
+    }
+
+    //Line of the text at ptr, for the error messages
+    unsigned lineOf(const char *begin, const char *ptr) {
+        return 1 + (unsigned) std::count(begin, ptr, '\n');
+    }
+}
+
+/**
+ * Replace the model by the patches of a text or binary file, recognized by its first bytes.
+ * On error, prints it and leaves the model empty
+ * @param filename
+ * @param report If not null, filled with the sizes and the times of the load
+ * @return
+ */
+bool PatchModel::load(const char *filename, PatchModelReport *report) {
+    clear();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FILE *in = fopen(filename, "rb");
+    if (in == nullptr) {
+        printf("[error] loading patch model '%s'...\n", filename);
+        return false;
+    }
+    std::vector<char> buffer;
+    if (fseek(in, 0, SEEK_END) == 0) {
+        long length = ftell(in);
+        if (length > 0) {
+            buffer.resize(length);
+            fseek(in, 0, SEEK_SET);
+            buffer.resize(fread(buffer.data(), 1, buffer.size(), in));
+        }
+    }
+    fclose(in);
+    double readMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    const char *begin = buffer.data(), *end = begin + buffer.size();
+    bool binary = buffer.size() >= sizeof(BINARY_MAGIC) && memcmp(begin, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+    bool ok = binary ? parseBinary(begin, end) : parseText(begin, end);
+    double parseMs = elapsedMs(start);
+    if (!ok)
+        printf("[error] loading patch model '%s'...\n", filename);
+
+    if (report) {
+        report->nbPatches = size();
+        report->nbPoints = (unsigned) ctrlPts.size();
+        report->bytes = buffer.size();
+        report->binary = binary;
+        report->readMs = readMs;
+        report->parseMs = parseMs;
+        report->patchesPerSecond = readMs + parseMs > 0 ? size() / ((readMs + parseMs) / 1000) : 0;
+    }
+    return ok;
+}
+
+/**
+ * Replace the model by the patches of the text format in [begin, end).
+ * On error, prints it with its line and leaves the model empty
+ * @param begin
+ * @param end
+ * @return
+ */
+bool PatchModel::parseText(const char *begin, const char *end) {
+    clear();
+    //Chunks cut after a line break, so that no number nor comment is split
+    std::size_t length = end - begin;
+    unsigned nbChunks = (unsigned) std::max<std::size_t>(1, (length + CHUNK - 1) / CHUNK);
+    std::vector<const char *> starts(nbChunks + 1, end);
+    starts[0] = begin;
+    for (unsigned c = 1; c < nbChunks; ++c) {
+        const char *ptr = std::max(begin + c * CHUNK, starts[c - 1]);
+        ptr = std::find(ptr, end, '\n');
+        starts[c] = ptr == end ? end : ptr + 1;
+    }
+
+    //Numbers of each chunk, and where its first error is
+    std::vector<std::vector<float>> tokens(nbChunks);
+    std::vector<const char *> errors(nbChunks, nullptr);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < (int) nbChunks; ++c) {
+        const char *ptr = starts[c], *last = starts[c + 1];
+        std::vector<float> &values = tokens[c];
+        values.reserve((last - ptr) / 8);
+        for (ptr = skipBlank(ptr, last); ptr < last; ptr = skipBlank(ptr, last)) {
+            float value;
+            const char *next = parseFloat(ptr, last, &value);
+            if (next == nullptr) {
+                errors[c] = ptr;
+                break;
+            }
+            values.push_back(value);
+            ptr = next;
+        }
+    }
+    for (unsigned c = 0; c < nbChunks; ++c)
+        if (errors[c]) {
+            printf("[error] patch model line %u : not a number\n", lineOf(begin, errors[c]));
+            return false;
+        }
+
+    std::vector<std::size_t> firstToken(nbChunks + 1, 0);
+    for (unsigned c = 0; c < nbChunks; ++c)
+        firstToken[c + 1] = firstToken[c] + tokens[c].size();
+    std::vector<float> values(firstToken[nbChunks]);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < (int) nbChunks; ++c)
+        std::copy(tokens[c].begin(), tokens[c].end(), values.begin() + firstToken[c]);
+    tokens.clear();
+
+    //Structure, one step per patch, and where the points of each patch start in values
+    unsigned nbPatches;
+    if (values.empty() || !toCount(values[0], ~0u, nbPatches)) {
+        printf("[error] patch model : no number of patches\n");
+        return false;
+    }
+    //Each patch takes at least its two degrees and one point, checked before sizing anything by the count
+    const std::size_t MIN_VALUES = 2 + 3;
+    if (nbPatches > (values.size() - 1) / MIN_VALUES) {
+        printf("[error] patch model : %u patches, the file has numbers for at most %zu\n", nbPatches,
+               (values.size() - 1) / MIN_VALUES);
+        return false;
+    }
+    std::vector<std::size_t> firstValue(nbPatches);
+    sizes.resize(2 * nbPatches);
+    offsets.resize(nbPatches + 1);
+    std::size_t pos = 1;
+    for (unsigned k = 0; k < nbPatches; ++k) {
+        unsigned degU, degV;
+        if (pos + 2 > values.size() || !toCount(values[pos], MAX_SIZE - 1, degU) ||
+            !toCount(values[pos + 1], MAX_SIZE - 1, degV)) {
+            printf("[error] patch model : patch %u has no degrees, or degrees above %u\n", k, MAX_SIZE - 1);
+            clear();
+            return false;
+        }
+        sizes[2 * k] = degU + 1;
+        sizes[2 * k + 1] = degV + 1;
+        offsets[k + 1] = offsets[k] + (degU + 1) * (degV + 1);
+        firstValue[k] = pos + 2;
+        pos += 2 + 3 * std::size_t(degU + 1) * (degV + 1);
+    }
+    if (pos != values.size()) {
+        printf("[error] patch model : %s numbers\n", pos > values.size() ? "missing" : "trailing");
+        clear();
+        return false;
+    }
+
+    ctrlPts.resize(offsets[nbPatches]);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int k = 0; k < (int) nbPatches; ++k) {
+        const float *src = &values[firstValue[k]];
+        for (unsigned m = offsets[k]; m < offsets[k + 1]; ++m, src += 3)
+            ctrlPts[m] = Point(src[0], src[1], src[2]);
+    }
+    return true;
+}
+
+/**
+ * Replace the model by the patches of the binary format in [begin, end).
+ * On error, prints it and leaves the model empty
+ * @param begin
+ * @param end
+ * @return
+ */
+bool PatchModel::parseBinary(const char *begin, const char *end) {
+    clear();
+    std::size_t length = end - begin;
+    uint32_t header[3];
+    if (length < sizeof(BINARY_MAGIC) + sizeof(header) || memcmp(begin, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+        printf("[error] patch model : not a binary patch model\n");
+        return false;
+    }
+    memcpy(header, begin + sizeof(BINARY_MAGIC), sizeof(header));
+    uint64_t nbPatches = header[1], nbPoints = header[2];
+    std::size_t first = sizeof(BINARY_MAGIC) + sizeof(header);
+    if (header[0] != BINARY_VERSION || first + nbPatches * 2 * sizeof(uint32_t) + nbPoints * sizeof(Point) != length) {
+        printf("[error] patch model : binary version %u or size %zu does not match\n", header[0], length);
+        return false;
+    }
+
+    sizes.resize(2 * nbPatches);
+    memcpy(sizes.data(), begin + first, sizes.size() * sizeof(uint32_t));
+    offsets.resize(nbPatches + 1);
+    uint64_t total = 0;
+    bool valid = true;
+    for (std::size_t k = 0; k < nbPatches && valid; ++k) {
+        valid = sizes[2 * k] > 0 && sizes[2 * k] <= MAX_SIZE && sizes[2 * k + 1] > 0 && sizes[2 * k + 1] <= MAX_SIZE;
+        total += sizes[2 * k] * sizes[2 * k + 1];
+        offsets[k + 1] = (unsigned) std::min<uint64_t>(total, nbPoints);
+    }
+    if (!valid || total != nbPoints) {
+        printf("[error] patch model : patch sizes do not match the %u points\n", header[2]);
+        clear();
+        return false;
+    }
+    ctrlPts.resize(nbPoints);
+    memcpy(ctrlPts.data(), begin + first + sizes.size() * sizeof(uint32_t), nbPoints * sizeof(Point));
+    return true;
+}
+
+/**
+ * Write the model in the text format, with enough digits to read the same floats back
+ * @param filename
+ * @return
+ */
+bool PatchModel::saveText(const char *filename) const {
+    FILE *out = fopen(filename, "wb");
+    if (out == nullptr) {
+        printf("[error] writing patch model '%s'...\n", filename);
+        return false;
+    }
+    fprintf(out, "%u\n", size());
+    for (unsigned k = 0; k < size(); ++k) {
+        fprintf(out, "%u %u\n", sizeU(k) - 1, sizeV(k) - 1);
+        for (unsigned m = offsets[k]; m < offsets[k + 1]; ++m)
+            fprintf(out, "%.9g %.9g %.9g\n", ctrlPts[m].x, ctrlPts[m].y, ctrlPts[m].z);
+    }
+    bool ok = fclose(out) == 0;
+    if (!ok)
+        printf("[error] writing patch model '%s'...\n", filename);
+    return ok;
+}
+
+/**
+ * Write the model in the binary format
+ * @param filename
+ * @return
+ */
+bool PatchModel::saveBinary(const char *filename) const {
+    FILE *out = fopen(filename, "wb");
+    if (out == nullptr) {
+        printf("[error] writing patch model '%s'...\n", filename);
+        return false;
+    }
+    uint32_t header[3] = {BINARY_VERSION, size(), (uint32_t) ctrlPts.size()};
+    fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), out);
+    fwrite(header, sizeof(uint32_t), 3, out);
+    fwrite(sizes.data(), sizeof(uint32_t), sizes.size(), out);
+    fwrite(ctrlPts.data(), sizeof(Point), ctrlPts.size(), out);
+    bool ok = !ferror(out);
+    ok = fclose(out) == 0 && ok;
+    if (!ok)
+        printf("[error] writing patch model '%s'...\n", filename);
+    return ok;
+}
+
+/**
+ * Append a copy of the control points of patch
+ * @param patch
+ */
+void PatchModel::add(const BezierSurface &patch) {
+    sizes.push_back(patch.sizeU());
+    sizes.push_back(patch.sizeV());
+    ctrlPts.insert(ctrlPts.end(), patch.getCtrlPts().begin(), patch.getCtrlPts().end());
+    offsets.push_back((unsigned) ctrlPts.size());
+}
+
+/**
+ * Remove all the patches
+ */
+void PatchModel::clear() {
+    ctrlPts.clear();
+    offsets.assign(1, 0);
+    sizes.clear();
+}
+
+/**
+ * @param k
+ * @return Patch k as a surface
+ */
+BezierSurface PatchModel::patch(const unsigned &k) const {
+    return BezierSurface(sizeU(k), sizeV(k),
+                         std::vector<Point>(ctrlPts.begin() + offsets[k], ctrlPts.begin() + offsets[k + 1]));
+}
+
+/**
+ * @return All the patches as surfaces, for PatchSetTessellator
+ */
+std::vector<BezierSurface> PatchModel::surfaces() const {
+    std::vector<BezierSurface> patches;
+    patches.reserve(size());
+    for (unsigned k = 0; k < size(); ++k)
+        patches.push_back(patch(k));
+    return patches;
+}
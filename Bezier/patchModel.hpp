@@ -0,0 +1,74 @@
+#pragma once
+
+#include "vec.h"
+#include <cstddef>
+#include <vector>
+
+class BezierSurface;
+
+//Outcome of PatchModel::load
+struct PatchModelReport {
+    unsigned nbPatches;
+    unsigned nbPoints;
+    std::size_t bytes;
+    bool binary;
+    //Reading the file, then parsing it into the flat arrays
+    double readMs;
+    double parseMs;
+    double patchesPerSecond;
+};
+
+/**
+ * Set of Bezier patches of any sizes, stored flat for batch tessellation : the control points of all the patches
+ * in one array, patch k being the row-major grid of sizeU(k) x sizeV(k) points starting at offset(k), as in
+ * BezierSurface.
+ * Two file formats :
+ *  - text, in the style of the teapot .bpt files : the number of patches, then for each patch its degrees in u
+ *    and v followed by its (degree u + 1) x (degree v + 1) points as x y z, row after row. Whitespace and line
+ *    breaks are free, # starts a comment up to the end of the line. The file is cut at line breaks into chunks tokenized
+ *    in parallel, the numbers are read as by parse_float of wavefront_fast.cpp, the patches are copied in
+ *    parallel
+ *  - binary : the 4 bytes BPTB, then as 32 bits unsigned integers the version 1, the number of patches and of
+ *    points, then the sizes u and v of each patch as 32 bits unsigned integers and the points as 3 floats, all
+ *    in the byte order of the machine
+ */
+class PatchModel {
+private:
+    std::vector<Point> ctrlPts;
+    //offsets[k] is the first point of patch k, offsets[size()] the number of points
+    std::vector<unsigned> offsets = {0};
+    //sizes[2 * k] and sizes[2 * k + 1], points of patch k in u and v
+    std::vector<unsigned> sizes;
+
+public:
+    //Largest number of points per direction of a patch read from a file
+    static const unsigned MAX_SIZE = 64;
+
+    bool load(const char *filename, PatchModelReport *report = nullptr);
+
+    bool parseText(const char *begin, const char *end);
+
+    bool parseBinary(const char *begin, const char *end);
+
+    bool saveText(const char *filename) const;
+
+    bool saveBinary(const char *filename) const;
+
+    void add(const BezierSurface &patch);
+
+    void clear();
+
+    unsigned size() const { return (unsigned) sizes.size() / 2; }
+
+    unsigned sizeU(const unsigned &k) const { return sizes[2 * k]; }
+
+    unsigned sizeV(const unsigned &k) const { return sizes[2 * k + 1]; }
+
+    unsigned offset(const unsigned &k) const { return offsets[k]; }
+
+    const std::vector<Point> &getCtrlPts() const { return ctrlPts; }
+
+    BezierSurface patch(const unsigned &k) const;
+
+    std::vector<BezierSurface> surfaces() const;
+};
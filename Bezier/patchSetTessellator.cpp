@@ -0,0 +1,318 @@
+#include "patchSetTessellator.hpp"
+#include "surface2D.hpp"
+#include "basisTableCache.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace {
+    //Point of the curve of control points ctrl at t, de Casteljau's method
+    Point casteljau(const std::vector<Point> &ctrl, const float &t) {
+        std::vector<Point> tmp(ctrl);
+        float t1 = 1 - t;
+        for (unsigned i = 1; i < tmp.size(); ++i)
+            for (unsigned j = 0; j < tmp.size() - i; ++j)
+                tmp[j] = tmp[j] * t1 + tmp[j + 1] * t;
+        return tmp[0];
+    }
+
+    bool lessPoint(const Point &a, const Point &b) {
+        return std::make_tuple(a.x, a.y, a.z) < std::make_tuple(b.x, b.y, b.z);
+    }
+
+    //Largest second difference of the control net across the rows (alongRows false) or along them
+    float secondDifference(const BezierSurface &patch, const bool &alongRows) {
+        unsigned nu = patch.sizeU(), nv = patch.sizeV();
+        float d = 0;
+        for (unsigned i = 0; i < nu; ++i)
+            for (unsigned j = 0; j < nv; ++j) {
+                if (alongRows ? j + 2 >= nv : i + 2 >= nu)
+                    continue;
+                const Point &a = patch.ctrlPt(i, j);
+                const Point &b = alongRows ? patch.ctrlPt(i, j + 1) : patch.ctrlPt(i + 1, j);
+                const Point &c = alongRows ? patch.ctrlPt(i, j + 2) : patch.ctrlPt(i + 2, j);
+                d = std::max(d, length(Vector(a) - 2 * Vector(b) + Vector(c)));
+            }
+        return d;
+    }
+}
+
+//Boundary curve shared by one patch or more, stored in its canonical direction
+struct PatchSetTessellator::Edge {
+    std::vector<Point> ctrl;
+    unsigned segments = 0;
+    unsigned users = 0;
+    //Vertices of both ends, and of the first of the segments - 1 inner samples
+    unsigned corner0 = 0, corner1 = 0;
+    unsigned first = 0;
+};
+
+/**
+ * Sides in the order u = 0, u = 1 (rows, parameter v) then v = 0, v = 1 (columns, parameter u)
+ */
+struct PatchSetTessellator::Patch {
+    unsigned segU = 0, segV = 0;
+    unsigned edges[4];
+    bool reversed[4];
+    //First inner grid vertex and first triangle
+    unsigned firstVertex = 0;
+    unsigned firstTriangle = 0;
+};
+
+/**
+ * @param epsilon
+ * @param maxSegments
+ */
+PatchSetTessellator::PatchSetTessellator(const float &epsilon, const unsigned &maxSegments)
+        : epsilon(epsilon), maxSegments(std::max(maxSegments, MIN_SEGMENTS)) {}
+
+/**
+ * Uniform number of segments keeping the patch within epsilon of its grid : along one direction, a polynomial
+ * of degree n sampled every h deviates from its chords by at most h^2 / 8 max |f''|, with |f''| at most
+ * n (n - 1) times the largest second difference of the control points. Each direction gets half of epsilon
+ * @param patch
+ * @param segU Segments across the rows, in [MIN_SEGMENTS, maxSegments]
+ * @param segV Segments along the rows
+ */
+void PatchSetTessellator::segments(const BezierSurface &patch, unsigned &segU, unsigned &segV) const {
+    unsigned du = patch.sizeU() > 0 ? patch.sizeU() - 1 : 0, dv = patch.sizeV() > 0 ? patch.sizeV() - 1 : 0;
+    float cu = float(du * (du > 0 ? du - 1 : 0)) * secondDifference(patch, false);
+    float cv = float(dv * (dv > 0 ? dv - 1 : 0)) * secondDifference(patch, true);
+    float eps = std::max(epsilon, 1e-12f) / 2;
+    segU = (unsigned) std::min<float>(maxSegments, std::max<float>(MIN_SEGMENTS, std::ceil(std::sqrt(cu / (8 * eps)))));
+    segV = (unsigned) std::min<float>(maxSegments, std::max<float>(MIN_SEGMENTS, std::ceil(std::sqrt(cv / (8 * eps)))));
+}
+
+/**
+ * Tessellate the patches with the segment counts of segments() and append them to mesh
+ * @param patches
+ * @param mesh GL_TRIANGLES mesh
+ * @return
+ */
+PatchSetReport PatchSetTessellator::tessellate(const std::vector<BezierSurface> &patches, Mesh &mesh) const {
+    std::vector<std::pair<unsigned, unsigned>> rates(patches.size());
+    int nbPatches = (int) patches.size();
+#pragma omp parallel for schedule(static)
+    for (int p = 0; p < nbPatches; ++p)
+        segments(patches[p], rates[p].first, rates[p].second);
+    return tessellate(patches, rates, mesh);
+}
+
+/**
+ * Tessellate the patches and append them to mesh, triangles oriented as BezierSurface::genMesh
+ * @param patches Patches with at least one control point
+ * @param rates Segments across and along the rows of each patch, raised to MIN_SEGMENTS
+ * @param mesh GL_TRIANGLES mesh
+ * @return
+ */
+PatchSetReport PatchSetTessellator::tessellate(const std::vector<BezierSurface> &patches,
+                                               const std::vector<std::pair<unsigned, unsigned>> &rates,
+                                               Mesh &mesh) const {
+    assert(rates.size() == patches.size());
+    PatchSetReport report = {0, 0, 0, 0};
+    std::vector<Patch> infos(patches.size());
+    std::vector<Edge> edges;
+
+    //Edges, keyed by their control points in canonical direction, and corners, keyed by position
+    std::map<std::vector<float>, unsigned> edgeIds;
+    std::map<std::tuple<float, float, float>, unsigned> cornerIds;
+    std::vector<Point> corners;
+    std::vector<float> key;
+    for (unsigned p = 0; p < patches.size(); ++p) {
+        const BezierSurface &patch = patches[p];
+        Patch &info = infos[p];
+        info.segU = std::max(rates[p].first, MIN_SEGMENTS);
+        info.segV = std::max(rates[p].second, MIN_SEGMENTS);
+        unsigned nu = patch.sizeU(), nv = patch.sizeV();
+        for (unsigned s = 0; s < 4; ++s) {
+            std::vector<Point> ctrl;
+            if (s < 2)
+                for (unsigned j = 0; j < nv; ++j)
+                    ctrl.push_back(patch.ctrlPt(s == 0 ? 0 : nu - 1, j));
+            else
+                for (unsigned i = 0; i < nu; ++i)
+                    ctrl.push_back(patch.ctrlPt(i, s == 2 ? 0 : nv - 1));
+            bool reversed = std::lexicographical_compare(ctrl.rbegin(), ctrl.rend(), ctrl.begin(), ctrl.end(),
+                                                         lessPoint);
+            if (reversed)
+                std::reverse(ctrl.begin(), ctrl.end());
+            key.clear();
+            for (const Point &pt: ctrl) {
+                key.push_back(pt.x);
+                key.push_back(pt.y);
+                key.push_back(pt.z);
+            }
+            auto found = edgeIds.find(key);
+            unsigned id;
+            if (found == edgeIds.end()) {
+                id = edges.size();
+                edgeIds[key] = id;
+                edges.emplace_back();
+                Edge &edge = edges.back();
+                edge.ctrl = ctrl;
+                for (unsigned end = 0; end < 2; ++end) {
+                    const Point &pt = end == 0 ? ctrl.front() : ctrl.back();
+                    auto corner = cornerIds.insert(std::make_pair(std::make_tuple(pt.x, pt.y, pt.z),
+                                                                  (unsigned) corners.size()));
+                    if (corner.second)
+                        corners.push_back(pt);
+                    (end == 0 ? edge.corner0 : edge.corner1) = corner.first->second;
+                }
+            } else
+                id = found->second;
+            Edge &edge = edges[id];
+            edge.segments = std::max(edge.segments, s < 2 ? info.segV : info.segU);
+            ++edge.users;
+            info.edges[s] = id;
+            info.reversed[s] = reversed;
+        }
+    }
+
+    //Vertex layout : corners, inner samples of the edges, inner grids of the patches
+    unsigned nbVertices = corners.size();
+    for (Edge &edge: edges) {
+        edge.first = nbVertices;
+        nbVertices += edge.segments - 1;
+        report.nbSharedEdges += edge.users > 1;
+    }
+    unsigned nbTriangles = 0;
+    for (Patch &info: infos) {
+        info.firstVertex = nbVertices;
+        nbVertices += (info.segU - 1) * (info.segV - 1);
+        info.firstTriangle = nbTriangles;
+        nbTriangles += 2 * (info.segU - 2) * (info.segV - 2);
+        for (unsigned s = 0; s < 4; ++s)
+            nbTriangles += edges[info.edges[s]].segments + (s < 2 ? info.segV : info.segU) - 2;
+    }
+    report.nbEdges = edges.size();
+    report.nbVertices = nbVertices;
+    report.nbTriangles = nbTriangles;
+
+    std::vector<vec3> positions(nbVertices);
+    std::vector<unsigned> triangles(3 * nbTriangles);
+    for (unsigned c = 0; c < corners.size(); ++c)
+        positions[c] = vec3(corners[c]);
+    int nbEdges = (int) edges.size(), nbPatches = (int) patches.size();
+
+    BasisTableCache &cache = BasisTableCache::instance();
+#pragma omp parallel
+    {
+        //Samples of an edge, evaluated once for all the patches using it
+#pragma omp for schedule(dynamic, 16)
+        for (int e = 0; e < nbEdges; ++e) {
+            const Edge &edge = edges[e];
+            for (unsigned k = 1; k < edge.segments; ++k)
+                positions[edge.first + k - 1] = vec3(casteljau(edge.ctrl, float(k) / float(edge.segments)));
+        }
+
+        std::vector<Point> rowPts;
+#pragma omp for schedule(dynamic, 4)
+        for (int p = 0; p < nbPatches; ++p) {
+            const BezierSurface &patch = patches[p];
+            const Patch &info = infos[p];
+            unsigned segU = info.segU, segV = info.segV;
+
+            //Inner grid (i, j), 0 < i < segU and 0 < j < segV, as Bu P Bv^T : the rows of control points are
+            //combined once per v sample into rowPts, then these along u. The basis tables are shared by all the
+            //patches of the same degrees and rates
+            unsigned nu = patch.sizeU(), nv = patch.sizeV();
+            std::shared_ptr<const BasisTable> tableU = cache.get(nu - 1, SamplingPlan(segU + 1));
+            std::shared_ptr<const BasisTable> tableV = cache.get(nv - 1, SamplingPlan(segV + 1));
+            const float *wu = tableU->bySample.data() + nu;
+            rowPts.resize(nu * (segV - 1));
+            for (unsigned j = 1; j < segV; ++j) {
+                const float *wv = &tableV->bySample[j * nv];
+                for (unsigned k = 0; k < nu; ++k) {
+                    Point pt(0, 0, 0);
+                    for (unsigned l = 0; l < nv; ++l)
+                        pt = pt + patch.ctrlPt(k, l) * wv[l];
+                    rowPts[k * (segV - 1) + j - 1] = pt;
+                }
+            }
+            for (unsigned i = 1; i < segU; ++i)
+                for (unsigned j = 1; j < segV; ++j) {
+                    Point pt(0, 0, 0);
+                    for (unsigned k = 0; k < nu; ++k)
+                        pt = pt + rowPts[k * (segV - 1) + j - 1] * wu[(i - 1) * nu + k];
+                    positions[info.firstVertex + (i - 1) * (segV - 1) + j - 1] = vec3(pt);
+                }
+            auto inner = [&](const unsigned &i, const unsigned &j) {
+                return info.firstVertex + (i - 1) * (segV - 1) + j - 1;
+            };
+
+            unsigned *out = &triangles[3 * info.firstTriangle];
+            for (unsigned i = 1; i < segU - 1; ++i)
+                for (unsigned j = 1; j < segV - 1; ++j) {
+                    unsigned a = inner(i, j), b = inner(i, j + 1), c = inner(i + 1, j), d = inner(i + 1, j + 1);
+                    unsigned quad[6] = {a, b, c, c, b, d};
+                    out = std::copy(quad, quad + 6, out);
+                }
+
+            //Transition strips, side samples against the matching side of the inner grid
+            for (unsigned s = 0; s < 4; ++s) {
+                const Edge &edge = edges[info.edges[s]];
+                unsigned m = edge.segments;
+                bool rows = s < 2;
+                unsigned count = rows ? segV : segU;
+                //Position across the side : u for the rows, v for the columns
+                float across = (s == 0 || s == 2) ? 0.f : 1.f;
+                float innerAcross = (s == 0) ? 1.f / segU : (s == 1) ? float(segU - 1) / segU
+                                  : (s == 2) ? 1.f / segV : float(segV - 1) / segV;
+                auto outerVertex = [&](const unsigned &k) {
+                    unsigned t = info.reversed[s] ? m - k : k;
+                    if (t == 0) return edge.corner0;
+                    if (t == m) return edge.corner1;
+                    return edge.first + t - 1;
+                };
+                auto innerVertex = [&](const unsigned &k) {
+                    if (rows)
+                        return inner(s == 0 ? 1 : segU - 1, k + 1);
+                    return inner(k + 1, s == 2 ? 1 : segV - 1);
+                };
+                //(u, v) of a strip vertex, orients the triangles
+                auto uv = [&](const bool &outer, const unsigned &k, float &u, float &v) {
+                    float along = outer ? float(k) / float(m) : float(k + 1) / float(count);
+                    float side = outer ? across : innerAcross;
+                    u = rows ? side : along;
+                    v = rows ? along : side;
+                };
+                auto emit = [&](const bool oa, const unsigned ka, const bool ob, const unsigned kb, const bool oc,
+                                const unsigned kc) {
+                    float ua, va, ub, vb, uc, vc;
+                    uv(oa, ka, ua, va);
+                    uv(ob, kb, ub, vb);
+                    uv(oc, kc, uc, vc);
+                    unsigned a = oa ? outerVertex(ka) : innerVertex(ka);
+                    unsigned b = ob ? outerVertex(kb) : innerVertex(kb);
+                    unsigned c = oc ? outerVertex(kc) : innerVertex(kc);
+                    //genMesh winding, negative area in (u, v)
+                    if ((ub - ua) * (vc - va) - (vb - va) * (uc - ua) > 0)
+                        std::swap(b, c);
+                    *out++ = a;
+                    *out++ = b;
+                    *out++ = c;
+                };
+
+                unsigned io = 0, ii = 0, last = count - 2;
+                while (io < m || ii < last) {
+                    bool advanceOuter = ii == last ||
+                                        (io < m && float(io + 1) / float(m) <= float(ii + 2) / float(count));
+                    if (advanceOuter) {
+                        emit(true, io, true, io + 1, false, ii);
+                        ++io;
+                    } else {
+                        emit(true, io, false, ii, false, ii + 1);
+                        ++ii;
+                    }
+                }
+            }
+        }
+    }
+
+    unsigned base = mesh.vertices(std::move(positions));
+    mesh.triangles(std::move(triangles), base);
+    return report;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vec.h"
+#include "mesh.h"
+#include <utility>
+#include <vector>
+
+class BezierSurface;
+
+//Outcome of PatchSetTessellator::tessellate
+struct PatchSetReport {
+    unsigned nbTriangles;
+    unsigned nbVertices;
+    //Patch boundaries, and those used by two patches or more
+    unsigned nbEdges;
+    unsigned nbSharedEdges;
+};
+
+/**
+ * Tessellation of a set of patches into one welded, crack-free mesh.
+ * Each patch gets its own number of segments along u and v, from a tolerance or given by the caller. Patch
+ * boundaries with the same control points, in either direction, are one edge : it is sampled once, with the
+ * largest number of segments its patches ask for, and these vertices are shared by all of them, as are the
+ * patch corners. Inside, each patch is a regular grid ; the ring of triangles between its edges and the grid is
+ * a transition strip zipping the two polylines by parameter, so neighbours of different rates meet without a
+ * T-junction. Rates, edge samples, patch points and triangles are computed in OpenMP parallel loops, and the
+ * result does not depend on the number of threads.
+ */
+class PatchSetTessellator {
+private:
+    float epsilon;
+    unsigned maxSegments;
+
+    struct Edge;
+    struct Patch;
+
+public:
+    //Patches get at least MIN_SEGMENTS segments per direction, so that they have an inner grid
+    static const unsigned MIN_SEGMENTS = 2;
+
+    /**
+     * @param epsilon Tolerance of the uniform segment counts, see segments
+     * @param maxSegments Largest number of segments per direction
+     */
+    explicit PatchSetTessellator(const float &epsilon, const unsigned &maxSegments = 64);
+
+    void segments(const BezierSurface &patch, unsigned &segU, unsigned &segV) const;
+
+    PatchSetReport tessellate(const std::vector<BezierSurface> &patches, Mesh &mesh) const;
+
+    PatchSetReport tessellate(const std::vector<BezierSurface> &patches,
+                              const std::vector<std::pair<unsigned, unsigned>> &rates, Mesh &mesh) const;
+};
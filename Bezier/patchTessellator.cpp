@@ -0,0 +1,343 @@
+#include "patchTessellator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <set>
+#include <unordered_map>
+
+namespace {
+    /**
+     * Split the curve of n points at 1/2 with de Casteljau's method, points read and written with a stride
+     * @param src
+     * @param n
+     * @param stride Distance between two points of the curve in src, left and right
+     * @param left First half, n points
+     * @param right Second half, n points
+     * @param tmp n points of scratch
+     */
+    void halve(const Point *src, const unsigned &n, const unsigned &stride, Point *left, Point *right, Point *tmp) {
+        for (unsigned k = 0; k < n; ++k)
+            tmp[k] = src[k * stride];
+        left[0] = tmp[0];
+        right[(n - 1) * stride] = tmp[n - 1];
+        for (unsigned i = 1; i < n; ++i) {
+            for (unsigned j = 0; j < n - i; ++j)
+                tmp[j] = center(tmp[j], tmp[j + 1]);
+            left[i * stride] = tmp[0];
+            right[(n - 1 - i) * stride] = tmp[n - 1 - i];
+        }
+    }
+
+    /**
+     * Split a nu x nv control net in four at (1/2, 1/2)
+     * @param net
+     * @param quarters Filled with the nets of [0, 1/2] x [0, 1/2], [1/2, 1] x [0, 1/2], [0, 1/2] x [1/2, 1] and
+     * [1/2, 1] x [1/2, 1], in u x v
+     */
+    void split(const std::vector<Point> &net, const unsigned &nu, const unsigned &nv, std::vector<Point> *quarters) {
+        std::vector<Point> low(nu * nv), high(nu * nv), tmp(std::max(nu, nv));
+        //Across the rows : columns of nu points, stride nv
+        for (unsigned j = 0; j < nv; ++j)
+            halve(net.data() + j, nu, nv, low.data() + j, high.data() + j, tmp.data());
+        //Along the rows
+        for (unsigned q = 0; q < 4; ++q)
+            quarters[q].resize(nu * nv);
+        for (unsigned i = 0; i < nu; ++i) {
+            halve(low.data() + i * nv, nv, 1, quarters[0].data() + i * nv, quarters[2].data() + i * nv, tmp.data());
+            halve(high.data() + i * nv, nv, 1, quarters[1].data() + i * nv, quarters[3].data() + i * nv, tmp.data());
+        }
+    }
+
+    //Point of the patch at (1/2, 1/2)
+    Point netCenter(const std::vector<Point> &net, const unsigned &nu, const unsigned &nv) {
+        std::vector<Point> rows(nu), tmp(nv);
+        for (unsigned i = 0; i < nu; ++i) {
+            std::copy(net.begin() + i * nv, net.begin() + (i + 1) * nv, tmp.begin());
+            for (unsigned k = 1; k < nv; ++k)
+                for (unsigned j = 0; j < nv - k; ++j)
+                    tmp[j] = center(tmp[j], tmp[j + 1]);
+            rows[i] = tmp[0];
+        }
+        for (unsigned k = 1; k < nu; ++k)
+            for (unsigned i = 0; i < nu - k; ++i)
+                rows[i] = center(rows[i], rows[i + 1]);
+        return rows[0];
+    }
+
+    //Triangles of a leaf with k boundary vertices
+    unsigned leafTriangles(const unsigned &k) {
+        return k == 4 ? 2 : k;
+    }
+
+    //Vertex key, integer coordinates on the 2^(maxDepth + 1) grid
+    uint32_t key(const unsigned &u, const unsigned &v) {
+        return (uint32_t) u << 16 | (uint32_t) v;
+    }
+}
+
+/**
+ * Quadtree of the parameter square, with the vertices of the leaves indexed by the lines they lie on
+ */
+struct PatchTessellator::Tree {
+    struct Node {
+        //Corner and size on the integer grid
+        unsigned u0, v0, size;
+        unsigned level;
+        //First of the 4 children, 0 for a leaf
+        unsigned child;
+        float error;
+        std::vector<Point> net;
+    };
+
+    unsigned nu, nv;
+    std::vector<Node> nodes;
+    //Vertices on the lines v = const, by u, and on the lines u = const, by v
+    std::map<unsigned, std::set<unsigned>> alongU;
+    std::map<unsigned, std::set<unsigned>> alongV;
+    unsigned nbTriangles = 0;
+
+    bool insert(const unsigned &u, const unsigned &v) {
+        alongV[u].insert(v);
+        return alongU[v].insert(u).second;
+    }
+
+    void erase(const unsigned &u, const unsigned &v) {
+        alongU[v].erase(u);
+        alongV[u].erase(v);
+    }
+
+    //Number of vertices of the line in [a, b]
+    static unsigned count(const std::map<unsigned, std::set<unsigned>> &lines, const unsigned &line,
+                          const unsigned &a, const unsigned &b) {
+        auto it = lines.find(line);
+        if (it == lines.end() || a > b)
+            return 0;
+        return std::distance(it->second.lower_bound(a), it->second.upper_bound(b));
+    }
+
+    //Vertices on the boundary of the square (u0, v0, size), corners included
+    unsigned boundary(const unsigned &u0, const unsigned &v0, const unsigned &size) const {
+        unsigned u1 = u0 + size, v1 = v0 + size;
+        return count(alongU, v0, u0, u1) + count(alongU, v1, u0, u1) + count(alongV, u0, v0 + 1, v1 - 1) +
+               count(alongV, u1, v0 + 1, v1 - 1);
+    }
+
+    //Leaf containing the grid point (u, v), cells are closed on their low sides
+    unsigned locate(const unsigned &u, const unsigned &v) const {
+        unsigned n = 0;
+        while (nodes[n].child) {
+            const Node &node = nodes[n];
+            unsigned half = node.size / 2;
+            n = node.child + (u >= node.u0 + half ? 1 : 0) + (v >= node.v0 + half ? 2 : 0);
+        }
+        return n;
+    }
+};
+
+/**
+ * @param epsilon
+ * @param maxTriangles
+ * @param maxDepth
+ */
+PatchTessellator::PatchTessellator(const float &epsilon, const unsigned &maxTriangles, const unsigned &maxDepth)
+        : epsilon(epsilon), maxTriangles(maxTriangles), maxDepth(std::min(maxDepth, MAX_DEPTH)) {}
+
+/**
+ * Measure errors in pixels
+ * @param worldToPixels Projection from world to window coordinates, viewport * projection * view
+ */
+void PatchTessellator::setScreen(const Transform &worldToPixels) {
+    screenSpace = true;
+    worldToScreen = worldToPixels;
+}
+
+/**
+ * Measure errors in pixels of the image of the camera, its projection must have been set
+ * @param camera
+ */
+void PatchTessellator::setScreen(const Orbiter &camera) {
+    setScreen(camera.viewport() * camera.projection() * camera.view());
+}
+
+/**
+ * Error bound of a piece of patch approximated by two triangles : largest distance between a control point and
+ * the bilinear patch of the corners at its Greville parameters (i / (nu - 1), j / (nv - 1)), plus a quarter of
+ * the twist between the two triangles. In screen space, points are projected first and those behind the eye are
+ * clamped on a plane just in front of it, so pieces crossing the eye plane are refined first. Pieces entirely
+ * behind it have no error
+ * @param net
+ * @param nu
+ * @param nv
+ * @return
+ */
+float PatchTessellator::error(const std::vector<Point> &net, const unsigned &nu, const unsigned &nv) const {
+    std::vector<Point> projected;
+    if (screenSpace) {
+        const float W_MIN = 1e-4f;
+        bool visible = false;
+        for (const Point &p: net) {
+            vec4 h = worldToScreen(vec4(p.x, p.y, p.z, 1.f));
+            visible = visible || h.w > 0;
+            float w = std::max(h.w, W_MIN);
+            projected.emplace_back(h.x / w, h.y / w, 0.f);
+        }
+        if (!visible)
+            return 0;
+    }
+    const std::vector<Point> &pts = screenSpace ? projected : net;
+    const Point &p00 = pts[0], &p01 = pts[nv - 1], &p10 = pts[(nu - 1) * nv], &p11 = pts[nu * nv - 1];
+    float err = distance(p00 + (p11 - p10), p01) / 4;
+    for (unsigned i = 0; i < nu; ++i) {
+        float s = nu > 1 ? float(i) / float(nu - 1) : 0.f;
+        for (unsigned j = 0; j < nv; ++j) {
+            float t = nv > 1 ? float(j) / float(nv - 1) : 0.f;
+            Point bilinear = p00 * ((1 - s) * (1 - t)) + p01 * ((1 - s) * t) + p10 * (s * (1 - t)) + p11 * (s * t);
+            err = std::max(err, distance(pts[i * nv + j], bilinear));
+        }
+    }
+    return err;
+}
+
+/**
+ * Tessellate the patch and append it to mesh
+ * @param nu Number of rows of the control net
+ * @param nv Number of control points per row
+ * @param grid nu * nv control points, row-major, as BezierSurface::getCtrlPts
+ * @param mesh GL_TRIANGLES mesh, vertices and triangles are appended, oriented as BezierSurface::genMesh
+ * @return
+ */
+PatchTessellationReport PatchTessellator::tessellate(const unsigned &nu, const unsigned &nv,
+                                                     const std::vector<Point> &grid, Mesh &mesh) const {
+    PatchTessellationReport report = {0, 0, 0, 0.f, false};
+    if (nu == 0 || nv == 0)
+        return report;
+
+    Tree tree;
+    tree.nu = nu;
+    tree.nv = nv;
+    const unsigned side = 1u << (maxDepth + 1);
+    tree.nodes.push_back({0, 0, side, 0, 0, error(grid, nu, nv), grid});
+    tree.insert(0, 0);
+    tree.insert(side, 0);
+    tree.insert(0, side);
+    tree.insert(side, side);
+    tree.nbTriangles = 2;
+
+    typedef std::pair<float, unsigned> Entry;
+    std::priority_queue<Entry> queue;
+    queue.push(Entry(tree.nodes[0].error, 0));
+    std::vector<Point> quarters[4];
+    while (!queue.empty() && queue.top().first > epsilon) {
+        unsigned n = queue.top().second;
+        queue.pop();
+        if (tree.nodes[n].level == maxDepth) {
+            report.error = std::max(report.error, tree.nodes[n].error);
+            continue;
+        }
+        unsigned u0 = tree.nodes[n].u0, v0 = tree.nodes[n].v0, size = tree.nodes[n].size;
+        unsigned half = size / 2, u1 = u0 + size, v1 = v0 + size, cu = u0 + half, cv = v0 + half;
+
+        //Leaves across the edges gain the edge midpoints as boundary vertices
+        const unsigned mids[4][2] = {{cu, v0}, {cu, v1}, {u0, cv}, {u1, cv}};
+        const int outside[4][2] = {{0, -1}, {0, 0}, {-1, 0}, {0, 0}};
+        unsigned neighbours[4], before[4], nbNeighbours = 0;
+        for (unsigned e = 0; e < 4; ++e) {
+            unsigned u = mids[e][0], v = mids[e][1];
+            if (u == 0 && outside[e][0] < 0) continue;
+            if (v == 0 && outside[e][1] < 0) continue;
+            if (u == side || v == side) continue;
+            unsigned m = tree.locate(u + outside[e][0], v + outside[e][1]);
+            const Tree::Node &leaf = tree.nodes[m];
+            neighbours[nbNeighbours] = m;
+            before[nbNeighbours++] = leafTriangles(tree.boundary(leaf.u0, leaf.v0, leaf.size));
+        }
+
+        int delta = -(int) leafTriangles(tree.boundary(u0, v0, size));
+        bool inserted[5];
+        const unsigned added[5][2] = {{cu, v0}, {cu, v1}, {u0, cv}, {u1, cv}, {cu, cv}};
+        for (unsigned k = 0; k < 5; ++k)
+            inserted[k] = tree.insert(added[k][0], added[k][1]);
+
+        for (unsigned q = 0; q < 4; ++q)
+            delta += leafTriangles(tree.boundary(q & 1 ? cu : u0, q & 2 ? cv : v0, half));
+        for (unsigned k = 0; k < nbNeighbours; ++k) {
+            const Tree::Node &leaf = tree.nodes[neighbours[k]];
+            delta += (int) leafTriangles(tree.boundary(leaf.u0, leaf.v0, leaf.size)) - (int) before[k];
+        }
+        if (tree.nbTriangles + delta > maxTriangles) {
+            for (unsigned k = 0; k < 5; ++k)
+                if (inserted[k])
+                    tree.erase(added[k][0], added[k][1]);
+            report.budgetReached = true;
+            report.error = std::max(report.error, tree.nodes[n].error);
+            break;
+        }
+        tree.nbTriangles += delta;
+
+        split(tree.nodes[n].net, nu, nv, quarters);
+        unsigned child = tree.nodes.size();
+        unsigned level = tree.nodes[n].level + 1;
+        for (unsigned q = 0; q < 4; ++q) {
+            float err = error(quarters[q], nu, nv);
+            tree.nodes.push_back({q & 1 ? cu : u0, q & 2 ? cv : v0, half, level, 0, err, quarters[q]});
+            queue.push(Entry(err, child + q));
+        }
+        tree.nodes[n].child = child;
+        std::vector<Point>().swap(tree.nodes[n].net);
+    }
+    if (!queue.empty())
+        report.error = std::max(report.error, queue.top().first);
+
+    //Vertices : corners of the leaves, every vertex of the lines is one
+    std::unordered_map<uint32_t, unsigned> indices;
+    for (const Tree::Node &node: tree.nodes) {
+        if (node.child)
+            continue;
+        ++report.nbLeaves;
+        const unsigned corners[4][3] = {{node.u0, node.v0, 0}, {node.u0 + node.size, node.v0, (nu - 1) * nv},
+                                        {node.u0, node.v0 + node.size, nv - 1},
+                                        {node.u0 + node.size, node.v0 + node.size, nu * nv - 1}};
+        for (const auto &c: corners) {
+            uint32_t k = key(c[0], c[1]);
+            if (indices.find(k) == indices.end())
+                indices[k] = mesh.vertex(node.net[c[2]]);
+        }
+    }
+
+    //Triangles, boundary of each leaf counter clockwise in (u, v), emitted reversed like genMesh
+    std::vector<unsigned> ring;
+    for (const Tree::Node &node: tree.nodes) {
+        if (node.child)
+            continue;
+        unsigned u0 = node.u0, v0 = node.v0, u1 = u0 + node.size, v1 = v0 + node.size;
+        ring.clear();
+        const std::set<unsigned> &bottom = tree.alongU.at(v0), &top = tree.alongU.at(v1);
+        const std::set<unsigned> &left = tree.alongV.at(u0), &right = tree.alongV.at(u1);
+        for (auto it = bottom.lower_bound(u0); it != bottom.end() && *it < u1; ++it)
+            ring.push_back(indices.at(key(*it, v0)));
+        for (auto it = right.lower_bound(v0); it != right.end() && *it < v1; ++it)
+            ring.push_back(indices.at(key(u1, *it)));
+        for (auto it = std::set<unsigned>::const_reverse_iterator(top.upper_bound(u1));
+             it != top.rend() && *it > u0; ++it)
+            ring.push_back(indices.at(key(*it, v1)));
+        for (auto it = std::set<unsigned>::const_reverse_iterator(left.upper_bound(v1));
+             it != left.rend() && *it > v0; ++it)
+            ring.push_back(indices.at(key(u0, *it)));
+
+        if (ring.size() == 4) {
+            mesh.triangle(ring[0], ring[2], ring[1]);
+            mesh.triangle(ring[0], ring[3], ring[2]);
+            report.nbTriangles += 2;
+            continue;
+        }
+        unsigned c = mesh.vertex(netCenter(node.net, nu, nv));
+        ++report.nbVertices;
+        for (unsigned k = 0; k < ring.size(); ++k)
+            mesh.triangle(c, ring[(k + 1) % ring.size()], ring[k]);
+        report.nbTriangles += ring.size();
+    }
+    report.nbVertices += indices.size();
+    return report;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "vec.h"
+#include "mat.h"
+#include "mesh.h"
+#include "orbiter.h"
+#include <vector>
+
+//Outcome of PatchTessellator::tessellate
+struct PatchTessellationReport {
+    unsigned nbTriangles;
+    unsigned nbVertices;
+    unsigned nbLeaves;
+    //Largest error bound among the emitted leaves, in world units or pixels
+    float error;
+    //The refinement stopped on the triangle budget before reaching epsilon
+    bool budgetReached;
+};
+
+/**
+ * Adaptive tessellation of a Bezier patch into a watertight triangle mesh.
+ * The parameter square is refined as a quadtree, best first : the leaf with the largest error is split in four
+ * with de Casteljau's method until every leaf is within epsilon, reaches maxDepth, or splitting would exceed the
+ * triangle budget. The error of a leaf bounds the distance between its piece of surface and its two triangles :
+ * deviation of its control net from the bilinear patch of its corners, plus a quarter of the corner twist.
+ * With setScreen, both are measured after projection, in pixels, so distant or small patches get few triangles.
+ * Neighbouring leaves may differ by any number of levels : each leaf is triangulated against every vertex lying
+ * on its boundary (two triangles when there is none besides its corners, a fan around its center otherwise),
+ * so there is no T-junction and the mesh has no crack.
+ */
+class PatchTessellator {
+private:
+    float epsilon;
+    unsigned maxTriangles;
+    unsigned maxDepth;
+
+    bool screenSpace = false;
+    Transform worldToScreen;
+
+    struct Tree;
+
+    float error(const std::vector<Point> &net, const unsigned &nu, const unsigned &nv) const;
+
+public:
+    //Deepest refinement level, vertex coordinates are kept on a 2^(level + 1) integer grid
+    static const unsigned MAX_DEPTH = 14;
+
+    /**
+     * @param epsilon Largest error of the triangles, world units, or pixels after setScreen
+     * @param maxTriangles Triangle budget of a patch, at least the 2 triangles of the unrefined patch are emitted
+     * @param maxDepth Refinement depth limit, at most MAX_DEPTH
+     */
+    PatchTessellator(const float &epsilon, const unsigned &maxTriangles, const unsigned &maxDepth = 10);
+
+    void setScreen(const Transform &worldToPixels);
+
+    void setScreen(const Orbiter &camera);
+
+    PatchTessellationReport tessellate(const unsigned &nu, const unsigned &nv, const std::vector<Point> &grid,
+                                       Mesh &mesh) const;
+};
@@ -0,0 +1,70 @@
+#include "samplingPlan.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+    //Number of segments of length at most step in [lo, hi], a step dividing the interval up to float rounding
+    //gives exactly the quotient
+    unsigned segmentsOf(const float &step, const float &lo, const float &hi) {
+        assert(step > 0);
+        double r = (double(hi) - double(lo)) / double(step);
+        return (unsigned) std::max(1., std::ceil(r - r * 1e-5));
+    }
+}
+
+/**
+ * Constructor
+ * @param count Number of samples
+ * @param lo First sample
+ * @param hi Last sample when closed, end of the period otherwise
+ * @param closed
+ */
+SamplingPlan::SamplingPlan(const unsigned &count, const float &lo, const float &hi, const bool &closed)
+        : count(count), lo(lo), hi(hi), closed(closed) {}
+
+/**
+ * Closed plan whose samples are at most step apart, lo and hi included : step = 0.01 gives the 101 samples
+ * 0, 0.01... 1, step = 0.3 gives 0, 0.25, 0.5, 0.75, 1
+ * @param step Positive
+ * @param lo
+ * @param hi
+ * @return
+ */
+SamplingPlan SamplingPlan::fromStep(const float &step, const float &lo, const float &hi) {
+    return SamplingPlan(segmentsOf(step, lo, hi) + 1, lo, hi, true);
+}
+
+/**
+ * Periodic plan whose samples are at most step apart, from lo to hi excluded : step = 0.36 on [0, 360) gives
+ * 1000 angles
+ * @param step Positive
+ * @param lo
+ * @param hi
+ * @return
+ */
+SamplingPlan SamplingPlan::periodic(const float &step, const float &lo, const float &hi) {
+    return SamplingPlan(segmentsOf(step, lo, hi), lo, hi, false);
+}
+
+/**
+ * All the samples, in order
+ * @param out Resized to size()
+ */
+void SamplingPlan::params(std::vector<float> &out) const {
+    out.resize(count);
+    for (unsigned k = 0; k < count; ++k)
+        out[k] = (*this)[k];
+}
+
+/**
+ * Samples [begin, end) of part index among parts parts of sizes differing by one at most
+ * @param index
+ * @param parts
+ * @param begin
+ * @param end
+ */
+void SamplingPlan::part(const unsigned &index, const unsigned &parts, unsigned &begin, unsigned &end) const {
+    begin = (unsigned) ((unsigned long long) count * index / parts);
+    end = (unsigned) ((unsigned long long) count * (index + 1) / parts);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Parameters of a tessellation, given by their number rather than by a float step : sample k is
+ * lo + (hi - lo) k / segments, computed from the integer k, so the count does not depend on rounding and the
+ * ends are exact. A closed plan (curves, surfaces) includes hi as its last sample, a periodic one (angles of a
+ * surface of revolution) stops one segment before it.
+ * Generators size their output with size() before evaluating anything, and split the samples between threads
+ * with part().
+ */
+class SamplingPlan {
+private:
+    unsigned count;
+    float lo;
+    float hi;
+    bool closed;
+
+public:
+    explicit SamplingPlan(const unsigned &count = 2, const float &lo = 0, const float &hi = 1,
+                          const bool &closed = true);
+
+    static SamplingPlan fromStep(const float &step, const float &lo = 0, const float &hi = 1);
+
+    static SamplingPlan periodic(const float &step, const float &lo, const float &hi);
+
+    unsigned size() const { return count; }
+
+    unsigned segments() const { return closed ? (count > 1 ? count - 1 : 0) : count; }
+
+    bool isClosed() const { return closed; }
+
+    float domainMin() const { return lo; }
+
+    float domainMax() const { return hi; }
+
+    //Distance between consecutive samples
+    float spacing() const { return segments() > 0 ? (hi - lo) / float(segments()) : 0.f; }
+
+    float operator[](const unsigned &k) const {
+        if (closed && k + 1 == count && count > 1)
+            return hi;
+        return segments() > 0 ? lo + (hi - lo) * (float(k) / float(segments())) : lo;
+    }
+
+    bool operator==(const SamplingPlan &other) const {
+        return count == other.count && lo == other.lo && hi == other.hi && closed == other.closed;
+    }
+
+    bool operator!=(const SamplingPlan &other) const { return !(*this == other); }
+
+    void params(std::vector<float> &out) const;
+
+    void part(const unsigned &index, const unsigned &parts, unsigned &begin, unsigned &end) const;
+};
@@ -1,166 +1,668 @@
 #include "surface2D.hpp"
+#include "basisTableCache.hpp"
+#include "pack.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+    //Store the packed vectors divided by their length, or 0 where it is at most minLength
+    void normalize(const Pack &x, const Pack &y, const Pack &z, const float &minLength, vec3 *out,
+                   const unsigned &count) {
+        Pack l = psqrt(padd(pmul(x, x), padd(pmul(y, y), pmul(z, z))));
+        Pack inv = pdiv(pset1(1.f), pmax(l, pset1(minLength)));
+        storePoints(pmul(x, inv), pmul(y, inv), pmul(z, inv), out, count);
+        float lengths[CurveBatch::LANES];
+        pstore(lengths, l);
+        for (unsigned k = 0; k < count; ++k)
+            if (!(lengths[k] > minLength))
+                out[k] = vec3(0, 0, 0);
+    }
+
+    bool isZero(const vec3 &v) {
+        return v.x == 0 && v.y == 0 && v.z == 0;
+    }
+
+    //Replace the null vectors of a grid by the nearest non null one toward the middle of the grid, along u first and
+    //at most MAX_STEPS samples away. Degenerate rows and columns are poles or collapsed edges, a few samples wide
+    void repairFrames(std::vector<std::vector<vec3>> &frames) {
+        const int MAX_STEPS = 16;
+        int nbU = (int) frames.size();
+        bool any = false;
+        for (int a = 0; a < nbU && !any; ++a)
+            for (const vec3 &f: frames[a])
+                any = any || !isZero(f);
+        //A fully degenerate grid has nothing to copy
+        if (!any)
+            return;
+        for (int a = 0; a < nbU; ++a) {
+            int nbV = (int) frames[a].size();
+            for (int b = 0; b < nbV; ++b) {
+                if (!isZero(frames[a][b]))
+                    continue;
+                int su = 2 * a < nbU ? 1 : -1, sv = 2 * b < nbV ? 1 : -1;
+                for (int k = 1; k <= MAX_STEPS && k < std::max(nbU, nbV) && isZero(frames[a][b]); ++k) {
+                    int a1 = a + k * su, b1 = b + k * sv;
+                    if (a1 >= 0 && a1 < nbU && !isZero(frames[a1][b]))
+                        frames[a][b] = frames[a1][b];
+                    else if (b1 >= 0 && b1 < nbV && !isZero(frames[a][b1]))
+                        frames[a][b] = frames[a][b1];
+                }
+            }
+        }
+    }
+}
 
 /**
- *
- * @param pts
+ * Evaluate the curve of n control points at u with de Casteljau's method, the pyramid is computed in place
+ * @param pts n control points, overwritten
+ * @param n
  * @param u
  * @return
  */
-vec3 BezierSurface::Casteljau(const std::vector<Point> &pts, const float &u) {
-    std::vector<Point> tmp(pts);
-    unsigned long long n = tmp.size();
-    float u1 = 1 - u;
-    for (unsigned long long i = 1; i < n; ++i) {
-        for (unsigned long long j = 0; j < n - i; ++j)
-            tmp[j] = tmp[j] * u1 + tmp[j + 1] * u;
+Point BezierSurface::Casteljau(Point *pts, const unsigned &n, const float &u) {
+    //Local copies, pts could alias u and the parameter would be reloaded after each store
+    float u0 = u, u1 = 1 - u;
+    unsigned count = n;
+    for (unsigned i = 1; i < count; ++i) {
+        for (unsigned j = 0; j < count - i; ++j)
+            pts[j] = pts[j] * u1 + pts[j + 1] * u0;
     }
-    return tmp[0];
+    return count > 0 ? pts[0] : Point(0, 0, 0);
 }
 
 /**
- *
- * @param i
- * @param n
- * @return
+ * Dense copy of a control net given as rows. Rows shorter than the longest one are degree elevated to its length,
+ * which leaves their curve unchanged, so a ragged net keeps the surface it described when each row had its own
+ * degree. Empty rows become rows of points at the origin
+ * @param net
+ * @param nu Number of rows
+ * @param nv Length of the longest row
+ * @param grid Filled with nu * nv points, row-major
  */
-float BezierSurface::Bu(const unsigned &i, const unsigned &n) {
-    return cnp[n][i] * ui[i] * uni[n - i];
+void BezierSurface::flatten(const std::vector<std::vector<Point>> &net, unsigned &nu, unsigned &nv,
+                            std::vector<Point> &grid) {
+    nu = net.size();
+    nv = 0;
+    for (const std::vector<Point> &row: net)
+        nv = std::max(nv, (unsigned) row.size());
+    grid.assign(nu * nv, Point(0, 0, 0));
+
+    std::vector<Point> elevated;
+    for (unsigned i = 0; i < nu; ++i) {
+        const std::vector<Point> &row = net[i];
+        if (row.size() == nv || row.empty()) {
+            std::copy(row.begin(), row.end(), grid.begin() + i * nv);
+            continue;
+        }
+        //Degree elevation, Q_k = k / (m + 1) P_(k - 1) + (1 - k / (m + 1)) P_k for the m + 1 points P
+        elevated = row;
+        while (elevated.size() < nv) {
+            unsigned m = elevated.size();
+            Point last = elevated[m - 1];
+            for (unsigned k = m - 1; k > 0; --k) {
+                float a = float(k) / float(m);
+                elevated[k] = elevated[k - 1] * a + elevated[k] * (1 - a);
+            }
+            elevated.push_back(last);
+        }
+        std::copy(elevated.begin(), elevated.end(), grid.begin() + i * nv);
+    }
 }
 
 /**
- *
- * @param i
- * @param n
- * @return
+ * Bernstein bases matching the control net, across the rows and along the rows
  */
-float BezierSurface::Bv(const unsigned &i, const unsigned &n) {
-    return cnp[n][i] * vi[i] * vni[n - i];
+void BezierSurface::initBases() {
+    bool changed = basisU.getDegree() + 1 != nu || basisV.getDegree() + 1 != nv;
+    if (basisU.getDegree() + 1 != nu)
+        basisU = BernsteinBasis(nu > 0 ? nu - 1 : 0);
+    if (basisV.getDegree() + 1 != nv)
+        basisV = BernsteinBasis(nv > 0 ? nv - 1 : 0);
+    if (changed) {
+        sampleBasisU.clear();
+        sampleBasisV.clear();
+    }
+    updatePlanes();
 }
 
 /**
- *
- * @param u
+ * Copy the control net to the coordinate planes, when they are enabled
  */
-void BezierSurface::initU(const float &u) {
-    float u1 = 1 - u;
-    for (int k = 1; k < ctrlPts.size(); ++k) {
-        ui[k] = ui[k - 1] * u;
-        uni[k] = uni[k - 1] * u1;
+void BezierSurface::updatePlanes() {
+    if (!usePlanes) {
+        planeStride = 0;
+        planeX.clear();
+        planeY.clear();
+        planeZ.clear();
+        return;
     }
+    const unsigned lanes = CurveBatch::LANES;
+    planeStride = (nv + lanes - 1) / lanes * lanes;
+    planeX.assign(nu * planeStride, 0.f);
+    planeY.assign(nu * planeStride, 0.f);
+    planeZ.assign(nu * planeStride, 0.f);
+    for (unsigned i = 0; i < nu; ++i)
+        for (unsigned j = 0; j < nv; ++j) {
+            const Point &pt = ctrlPts[i * nv + j];
+            planeX[i * planeStride + j] = pt.x;
+            planeY[i * planeStride + j] = pt.y;
+            planeZ[i * planeStride + j] = pt.z;
+        }
 }
 
 /**
- *
- * @param v
+ * Parameters visited by the tessellation functions
+ * @param params Filled with the samples of SamplingPlan::fromStep(step), 0 and 1 included
+ * @param step
+ */
+void BezierSurface::sampleParams(std::vector<float> &params, const float &step) {
+    SamplingPlan::fromStep(step).params(params);
+}
+
+/**
+ * Bernstein values at the parameters of the tessellations of stepU x stepV, kept until a step or a degree change
+ * @param stepU
+ * @param stepV
  */
-void BezierSurface::initV(const float &v) {
-    float v1 = 1 - v;
-    for (int k = 1; k < ctrlPts[0].size(); ++k) {
-        vi[k] = vi[k - 1] * v;
-        vni[k] = vni[k - 1] * v1;
+void BezierSurface::updateSampleBasis(const float &stepU, const float &stepV) {
+    if (stepU == sampleStepU && stepV == sampleStepV && !sampleBasisU.empty())
+        return;
+    sampleStepU = stepU;
+    sampleStepV = stepV;
+    std::vector<float> us, vs;
+    sampleParams(us, stepU);
+    sampleParams(vs, stepV);
+    unsigned nbU = us.size(), nbV = vs.size();
+
+    std::vector<float> w(std::max(nu, nv) + 1);
+    sampleBasisU.resize(nu * nbU);
+    for (unsigned a = 0; a < nbU; ++a) {
+        basisU.weights(us[a], w.data());
+        for (unsigned i = 0; i < nu; ++i)
+            sampleBasisU[i * nbU + a] = w[i];
+    }
+    sampleBasisV.resize(nv * nbV);
+    for (unsigned b = 0; b < nbV; ++b) {
+        basisV.weights(vs[b], w.data());
+        for (unsigned j = 0; j < nv; ++j)
+            sampleBasisV[j * nbV + b] = w[j];
     }
 }
 
+/**
+ * Point of the row curve i, from the v weights. With the coordinate planes the sum is done a pack of
+ * CurveBatch::LANES control points at a time, so it only matches the point by point sum up to float rounding
+ * @param i Row
+ * @param wv Bernstein values along the rows, planeStride entries padded with zeros and 32 bytes aligned when the
+ * planes are enabled
+ * @return
+ */
+Point BezierSurface::rowPoint(const unsigned &i, const float *wv) const {
+    if (usePlanes) {
+        const float *px = planeX.data() + i * planeStride;
+        const float *py = planeY.data() + i * planeStride;
+        const float *pz = planeZ.data() + i * planeStride;
+        Pack x = pset1(0.f), y = pset1(0.f), z = pset1(0.f);
+        for (unsigned j = 0; j < planeStride; j += CurveBatch::LANES) {
+            Pack w = ploada(wv + j);
+            x = padd(x, pmul(ploada(px + j), w));
+            y = padd(y, pmul(ploada(py + j), w));
+            z = padd(z, pmul(ploada(pz + j), w));
+        }
+        float tx[CurveBatch::LANES], ty[CurveBatch::LANES], tz[CurveBatch::LANES];
+        pstore(tx, x);
+        pstore(ty, y);
+        pstore(tz, z);
+        Point pt(0, 0, 0);
+        for (unsigned k = 0; k < CurveBatch::LANES; ++k)
+            pt = pt + Vector(tx[k], ty[k], tz[k]);
+        return pt;
+    }
+    const Point *row = ctrlPts.data() + i * nv;
+    Point pt(0, 0, 0);
+    for (unsigned j = 0; j < nv; ++j)
+        pt = pt + row[j] * wv[j];
+    return pt;
+}
+
+/**
+ * Degree specialized evaluator of the control net, when both degrees are at most 5
+ * @param rows Filled with the row pointers the evaluator expects, at least 6 entries
+ * @return the evaluator, or null
+ */
+PatchEvaluatorN BezierSurface::specialized(const Point **rows) const {
+    PatchEvaluatorN eval = patchEvaluatorN(nu, nv);
+    if (eval)
+        for (unsigned i = 0; i < nu; ++i)
+            rows[i] = ctrlPts.data() + i * nv;
+    return eval;
+}
+
+/**
+ * Constructor
+ * @param ctrl Controls points, one vector per row, see flatten for rows of different lengths
+ */
+BezierSurface::BezierSurface(const std::vector<std::vector<Point>> &ctrl) {
+    flatten(ctrl, nu, nv, ctrlPts);
+    initBases();
+}
+
 /**
  * Constructor
- * @param ctrl Controls points
+ * @param nu Number of rows
+ * @param nv Number of control points per row
+ * @param grid nu * nv controls points, row-major
  */
-BezierSurface::BezierSurface(std::vector<std::vector<Point>> ctrl) : ctrlPts(std::move(ctrl)) {
-    ui.resize(16);
-    uni.resize(16);
-    vi.resize(16);
-    vni.resize(16);
-    ui[0] = 1.f;
-    uni[0] = 1.f;
-    vi[0] = 1.f;
-    vni[0] = 1.f;
+BezierSurface::BezierSurface(const unsigned &nu, const unsigned &nv, std::vector<Point> grid)
+        : nu(nu), nv(nv), ctrlPts(std::move(grid)) {
+    assert(ctrlPts.size() == nu * nv);
+    initBases();
 }
 
 /**
  * Change controls points
- * @param newPts New constrols points
+ * @param newPts New constrols points, one vector per row
  */
 void BezierSurface::changeCtrlPts(const std::vector<std::vector<Point>> &newPts) {
-    ctrlPts.clear();
-    ctrlPts = newPts;
+    flatten(newPts, nu, nv, ctrlPts);
+    initBases();
+}
+
+/**
+ * Change controls points
+ * @param newNu Number of rows
+ * @param newNv Number of control points per row
+ * @param grid newNu * newNv controls points, row-major
+ */
+void BezierSurface::changeCtrlPts(const unsigned &newNu, const unsigned &newNv, const std::vector<Point> &grid) {
+    assert(grid.size() == newNu * newNv);
+    nu = newNu;
+    nv = newNv;
+    ctrlPts = grid;
+    initBases();
+}
+
+/**
+ * Keep the control net as coordinate planes as well, read by Analytical2D above bi-quintic nets.
+ * Costs three floats per control point, rows padded to CurveBatch::LANES
+ * @param enable
+ */
+void BezierSurface::setPlanar(const bool &enable) {
+    usePlanes = enable;
+    updatePlanes();
 }
 
 /**
- * Compute one point, not the most optimal code for a full surface calculation
+ * Move one control point
+ * @param i Row of the control point
+ * @param j Index in the row
+ * @param delta Translation
+ */
+void BezierSurface::moveCtrlPt(const unsigned &i, const unsigned &j, const Vector &delta) {
+    assert(i < nu && j < nv);
+    Point &pt = ctrlPts[i * nv + j];
+    pt = pt + delta;
+    if (usePlanes) {
+        planeX[i * planeStride + j] = pt.x;
+        planeY[i * planeStride + j] = pt.y;
+        planeZ[i * planeStride + j] = pt.z;
+    }
+}
+
+/**
+ * Move one control point and patch the points of a step tessellation in place : the surface is linear in its
+ * control points, so the point (u_a, v_b) moves by delta Bu_i(u_a) Bv_j(v_b), a rank one update with the
+ * cached basis values. Float rounding accumulates over many moves, a full tessellation resets it
+ * @param i Row of the control point
+ * @param j Index in the row
+ * @param delta Translation
+ * @param surfacePts Points of CalculateSurfacePointsCasteljau or CalculateSurfacePointsAnalytical with the same steps,
+ * fully recomputed when their size does not match
+ * @param stepU
+ * @param stepV
+ */
+void BezierSurface::moveCtrlPt(const unsigned &i, const unsigned &j, const Vector &delta,
+                               std::vector<std::vector<vec3>> &surfacePts, const float &stepU, const float &stepV) {
+    assert(i < nu && j < nv);
+    moveCtrlPt(i, j, delta);
+    updateSampleBasis(stepU, stepV);
+    unsigned nbU = ctrlPts.empty() ? 0 : sampleBasisU.size() / nu;
+    unsigned nbV = ctrlPts.empty() ? 0 : sampleBasisV.size() / nv;
+    bool match = surfacePts.size() == nbU;
+    for (unsigned a = 0; a < surfacePts.size() && match; ++a)
+        match = surfacePts[a].size() == nbV;
+    if (!match) {
+        CalculateSurfacePointsAnalytical(surfacePts, stepU, stepV);
+        return;
+    }
+
+    const float *bu = &sampleBasisU[i * nbU];
+    const float *bv = &sampleBasisV[j * nbV];
+    for (unsigned a = 0; a < nbU; ++a) {
+        if (bu[a] == 0)
+            continue;
+        float dx = delta.x * bu[a], dy = delta.y * bu[a], dz = delta.z * bu[a];
+        vec3 *row = surfacePts[a].data();
+        for (unsigned b = 0; b < nbV; ++b) {
+            row[b].x += dx * bv[b];
+            row[b].y += dy * bv[b];
+            row[b].z += dz * bv[b];
+        }
+    }
+}
+
+/**
+ * Compute one point, not the most optimal code for a full surface calculation.
+ * Uses the degree specialized evaluator up to bi-quintic nets, the Bernstein basis engine above
  * @param u
  * @param v
  * @return
  */
-vec3 BezierSurface::Analytical2D(const float &u, const float &v) {
-    initU(u);
-    initV(v);
-    unsigned n = ctrlPts.size();
-    vec3 pt(0, 0, 0);
-    for (int i = 0; i < n; ++i) {
-        unsigned m = ctrlPts[i].size();
-        for (int j = 0; j < m; ++j)
-            pt = (Point) pt + ctrlPts[i][j] * Bu(i, n - 1) * Bv(j, m - 1);
-    }
-
+vec3 BezierSurface::Analytical2D(const float &u, const float &v) const {
+    const Point *rows[6];
+    if (PatchEvaluatorN eval = specialized(rows))
+        return eval(rows, u, v);
+    std::vector<float> wu(nu + 1);
+    AlignedFloats wv(std::max(nv + 1, planeStride), 0.f);
+    basisU.weights(u, wu.data());
+    basisV.weights(v, wv.data());
+    Point pt(0, 0, 0);
+    for (unsigned i = 0; i < nu; ++i)
+        pt = pt + rowPoint(i, wv.data()) * wu[i];
     return pt;
 }
 
 /**
- * Compute one point of the surface
+ * Compute one point of the surface without allocating : stack scratch up to STACK_SCRATCH rows plus points per row,
+ * above a scratch per thread, grown to the largest net evaluated on the thread (the only allocations)
  * @param u
  * @param v
  * @return
  */
 vec3 BezierSurface::Casteljau2D(const float &u, const float &v) const {
-    std::vector<Point> pts;
-    vec3 pt(0, 0, 0);
-    for (const std::vector<Point> &row: ctrlPts)
-        pts.emplace_back(Casteljau(row, v));
-    return Casteljau(pts, u);
+    if (nu + nv <= STACK_SCRATCH) {
+        Point scratch[STACK_SCRATCH];
+        return Casteljau2D(u, v, scratch);
+    }
+    static thread_local std::vector<Point> scratch;
+    if (scratch.size() < nu + nv)
+        scratch.resize(nu + nv);
+    return Casteljau2D(u, v, scratch.data());
 }
 
 /**
- * Compute surface
- * curvePts must be an empty vector, which will be filled with each calculated point
- * @param surfacePts
+ * Compute one point of the surface : each row is reduced at v, then the column of row points at u
+ * @param u
+ * @param v
+ * @param scratch casteljauScratchSize() points, lets callers evaluate many points without allocating
+ * @return
+ */
+vec3 BezierSurface::Casteljau2D(const float &u, const float &v, Point *scratch) const {
+    Point *pts = scratch;
+    Point *row = scratch + nu;
+    for (unsigned i = 0; i < nu; ++i) {
+        std::copy(ctrlPts.begin() + i * nv, ctrlPts.begin() + (i + 1) * nv, row);
+        pts[i] = Casteljau(row, nv, v);
+    }
+    return Casteljau(pts, nu, u);
+}
+
+/**
+ * Compute surface with de Casteljau's method, rows of u samples spread over the OpenMP threads, each with its
+ * Casteljau2D scratch
+ * @param surfacePts Resized to one row of v samples per u sample
  * @param stepU
  * @param stepV
  */
 void BezierSurface::CalculateSurfacePointsCasteljau(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
                                                     const float &stepV) const {
-    surfacePts.clear();
-    for (float i = 0; i <= 1; i += stepU) {
-        surfacePts.emplace_back();
-        for (float j = 0; j <= 1; j += stepV) {
-            surfacePts.back().emplace_back(Casteljau2D(i, j));
+    CalculateSurfacePointsCasteljau(surfacePts, SamplingPlan::fromStep(stepU), SamplingPlan::fromStep(stepV));
+}
+
+/**
+ * Compute surface with de Casteljau's method at the samples of planU x planV
+ * @param surfacePts Resized to planU.size() rows of planV.size() points
+ * @param planU
+ * @param planV
+ */
+void BezierSurface::CalculateSurfacePointsCasteljau(std::vector<std::vector<vec3>> &surfacePts,
+                                                    const SamplingPlan &planU, const SamplingPlan &planV) const {
+    std::vector<float> us, vs;
+    planU.params(us);
+    planV.params(vs);
+    int nbU = (int) us.size();
+    surfacePts.resize(nbU);
+#pragma omp parallel
+    {
+        std::vector<Point> scratch(casteljauScratchSize());
+#pragma omp for schedule(dynamic, 4)
+        for (int a = 0; a < nbU; ++a) {
+            std::vector<vec3> &row = surfacePts[a];
+            row.resize(vs.size());
+            for (unsigned b = 0; b < vs.size(); ++b)
+                row[b] = Casteljau2D(us[a], vs[b], scratch.data());
         }
     }
 }
 
 /**
- * Compute surface
- * @param surfacePts
+ * Compute surface as the matrix products Bu P Bv^T : the basis tables of both directions are built once, then
+ * the rows of control points are combined along v into one curve point per (row, v sample), T = P Bv^T, and
+ * these along u into the grid, Bu T. Both products run on packs of CurveBatch::LANES v samples, the second by
+ * tiles of v samples so that the tile of T stays in cache while all the u samples of a block go over it.
+ * Costs nu nv + nu per grid point instead of nu nv, points match Analytical2D up to float rounding.
+ * The tables, T and the blocks of u samples are spread over the OpenMP threads
+ * @param surfacePts Resized to one row of v samples per u sample
  * @param stepU
  * @param stepV
  */
 void BezierSurface::CalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
-                                                     const float &stepV) {
-    surfacePts.clear();
-    unsigned nu = ctrlPts.size();
-    for (float i = 0; i <= 1; i += stepU) {
-        surfacePts.emplace_back();
-        initU(i);
-        for (float j = 0; j <= 1; j += stepV) {
-            initV(j);
-            vec3 pt(0, 0, 0);
-            for (int k = 0; k < nu; ++k) {
-                unsigned nv = ctrlPts[k].size();
-                for (int h = 0; h < nv; ++h) {
-                    pt = (Point) pt + ctrlPts[k][h] * Bu(k, nu - 1) * Bv(h, nv - 1);
+                                                     const float &stepV) const {
+    gridProducts(surfacePts, nullptr, nullptr, SamplingPlan::fromStep(stepU), SamplingPlan::fromStep(stepV));
+}
+
+/**
+ * Compute surface as the matrix products Bu P Bv^T at the samples of planU x planV
+ * @param surfacePts Resized to planU.size() rows of planV.size() points
+ * @param planU
+ * @param planV
+ */
+void BezierSurface::CalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts,
+                                                     const SamplingPlan &planU, const SamplingPlan &planV) const {
+    gridProducts(surfacePts, nullptr, nullptr, planU, planV);
+}
+
+/**
+ * CalculateSurfacePointsAnalytical with the unit normals, and optionally the unit tangents along u, in the same
+ * pass : the derivative tables Bu' and Bv' give dS/du = Bu' T and dS/dv = Bu P Bv'^T next to the points, and the
+ * normal is dS/dv x dS/du, on the front side of the genMesh triangles.
+ * Where a derivative vanishes (a row or column of the net collapsed to a point), the frame of the nearest regular
+ * sample toward the middle of the grid is used
+ * @param surfacePts Resized to one row of v samples per u sample
+ * @param normals Same layout as surfacePts
+ * @param stepU
+ * @param stepV
+ * @param tangents If not null, same layout as surfacePts
+ */
+void BezierSurface::CalculateSurfaceFramesAnalytical(std::vector<std::vector<vec3>> &surfacePts,
+                                                     std::vector<std::vector<vec3>> &normals, const float &stepU,
+                                                     const float &stepV,
+                                                     std::vector<std::vector<vec3>> *tangents) const {
+    gridProducts(surfacePts, &normals, tangents, SamplingPlan::fromStep(stepU), SamplingPlan::fromStep(stepV));
+}
+
+/**
+ * CalculateSurfaceFramesAnalytical at the samples of planU x planV
+ * @param surfacePts Resized to planU.size() rows of planV.size() points
+ * @param normals Same layout as surfacePts
+ * @param planU
+ * @param planV
+ * @param tangents If not null, same layout as surfacePts
+ */
+void BezierSurface::CalculateSurfaceFramesAnalytical(std::vector<std::vector<vec3>> &surfacePts,
+                                                     std::vector<std::vector<vec3>> &normals,
+                                                     const SamplingPlan &planU, const SamplingPlan &planV,
+                                                     std::vector<std::vector<vec3>> *tangents) const {
+    gridProducts(surfacePts, &normals, tangents, planU, planV);
+}
+
+/**
+ * Grid of CalculateSurfacePointsAnalytical, with the frames of CalculateSurfaceFramesAnalytical when normals is
+ * not null
+ * @param surfacePts
+ * @param normals
+ * @param tangents Only filled along with normals
+ * @param planU
+ * @param planV
+ */
+void BezierSurface::gridProducts(std::vector<std::vector<vec3>> &surfacePts, std::vector<std::vector<vec3>> *normals,
+                                 std::vector<std::vector<vec3>> *tangents, const SamplingPlan &planU,
+                                 const SamplingPlan &planV) const {
+    const unsigned lanes = CurveBatch::LANES;
+    //v samples per tile of the second product, nu * TILE * 3 floats of T
+    const unsigned TILE = 256;
+    bool frames = normals != nullptr;
+    if (!frames)
+        tangents = nullptr;
+
+    unsigned nbU = planU.size(), nbV = planV.size();
+    surfacePts.resize(nbU);
+    if (frames)
+        normals->resize(nbU);
+    if (tangents)
+        tangents->resize(nbU);
+    if (nu == 0 || nv == 0) {
+        for (unsigned a = 0; a < nbU; ++a) {
+            surfacePts[a].assign(nbV, vec3(0, 0, 0));
+            if (frames)
+                (*normals)[a].assign(nbV, vec3(0, 0, 0));
+            if (tangents)
+                (*tangents)[a].assign(nbV, vec3(0, 0, 0));
+        }
+        return;
+    }
+
+    //Basis tables shared with every surface of the same degrees sampled the same way, tableU[a * nu + i] =
+    //Bu_i(u_a) and tableV[j * stride + b] = Bv_j(v_b), padded with zeros, and their derivatives with the frames
+    BasisTableCache &cache = BasisTableCache::instance();
+    std::shared_ptr<const BasisTable> basisTableU = cache.get(nu - 1, planU, frames);
+    std::shared_ptr<const BasisTable> basisTableV = cache.get(nv - 1, planV, frames);
+    const float *tableU = basisTableU->bySample.data(), *tableDU = basisTableU->derivBySample.data();
+    const float *tableV = basisTableV->byCoefficient.data(), *tableDV = basisTableV->derivByCoefficient.data();
+    unsigned stride = basisTableV->stride;
+    //T = P Bv^T, one plane per axis, tx[i * stride + b] = x of row curve i at v_b, and T' = P Bv'^T
+    AlignedFloats tx(nu * stride), ty(nu * stride), tz(nu * stride);
+    AlignedFloats dx(frames ? nu * stride : 0), dy(frames ? nu * stride : 0), dz(frames ? nu * stride : 0);
+    //u samples per block of the grid loop, the unit of work of the threads
+    const int BLOCK = 16;
+    int nbBlocks = (int) ((nbU + BLOCK - 1) / BLOCK);
+    //The products run on the net centered on its box, so that their rounding scales with the size of the net and
+    //not with its distance to the origin; the center is added back to the points (the weights sum to 1)
+    Point pmin = ctrlPts[0], pmax = ctrlPts[0];
+    for (const Point &pt: ctrlPts) {
+        pmin = min(pmin, pt);
+        pmax = max(pmax, pt);
+    }
+    Point c = center(pmin, pmax);
+    //Derivatives are about the degree times the size of the net, far below it they are the rounding noise of a
+    //collapsed row or column
+    float size = distance(pmin, pmax);
+    float scaleU = size * float(std::max(nu - 1, 1u)), scaleV = size * float(std::max(nv - 1, 1u));
+    float minNormal = 1e-5f * scaleU * scaleV, minTangent = 1e-5f * scaleU;
+
+    //Each point is computed by one thread with the same operations whatever the number of threads, so the grid
+    //does not depend on it
+#pragma omp parallel
+    {
+#pragma omp for schedule(static)
+        for (int i = 0; i < (int) nu; ++i) {
+            const Point *row = ctrlPts.data() + i * nv;
+            for (unsigned b = 0; b < stride; b += lanes) {
+                Pack x = pset1(0.f), y = pset1(0.f), z = pset1(0.f);
+                for (unsigned j = 0; j < nv; ++j) {
+                    Pack bv = ploada(&tableV[j * stride + b]);
+                    x = padd(x, pmul(pset1(row[j].x - c.x), bv));
+                    y = padd(y, pmul(pset1(row[j].y - c.y), bv));
+                    z = padd(z, pmul(pset1(row[j].z - c.z), bv));
+                }
+                pstore(&tx[i * stride + b], x);
+                pstore(&ty[i * stride + b], y);
+                pstore(&tz[i * stride + b], z);
+                if (!frames)
+                    continue;
+                x = y = z = pset1(0.f);
+                for (unsigned j = 0; j < nv; ++j) {
+                    Pack bv = ploada(&tableDV[j * stride + b]);
+                    x = padd(x, pmul(pset1(row[j].x - c.x), bv));
+                    y = padd(y, pmul(pset1(row[j].y - c.y), bv));
+                    z = padd(z, pmul(pset1(row[j].z - c.z), bv));
                 }
+                pstore(&dx[i * stride + b], x);
+                pstore(&dy[i * stride + b], y);
+                pstore(&dz[i * stride + b], z);
             }
-            surfacePts.back().emplace_back(pt);
         }
+
+        //Grid = Bu T, each block of u samples tile by tile of v samples
+#pragma omp for schedule(static)
+        for (int block = 0; block < nbBlocks; ++block) {
+            unsigned a0 = block * BLOCK, a1 = std::min(a0 + BLOCK, nbU);
+            //Rows are sized by the thread that fills them
+            for (unsigned a = a0; a < a1; ++a) {
+                surfacePts[a].resize(nbV);
+                if (frames)
+                    (*normals)[a].resize(nbV);
+                if (tangents)
+                    (*tangents)[a].resize(nbV);
+            }
+            for (unsigned b0 = 0; b0 < nbV; b0 += TILE) {
+                unsigned b1 = std::min(b0 + TILE, nbV);
+                for (unsigned a = a0; a < a1; ++a) {
+                    const float *bu = &tableU[a * nu];
+                    vec3 *out = surfacePts[a].data();
+                    for (unsigned b = b0; b < b1; b += lanes) {
+                        Pack x = pset1(0.f), y = pset1(0.f), z = pset1(0.f);
+                        for (unsigned i = 0; i < nu; ++i) {
+                            Pack wu = pset1(bu[i]);
+                            x = padd(x, pmul(ploada(&tx[i * stride + b]), wu));
+                            y = padd(y, pmul(ploada(&ty[i * stride + b]), wu));
+                            z = padd(z, pmul(ploada(&tz[i * stride + b]), wu));
+                        }
+                        storePoints(padd(x, pset1(c.x)), padd(y, pset1(c.y)), padd(z, pset1(c.z)), out + b,
+                                    std::min(lanes, b1 - b));
+                        if (!frames)
+                            continue;
+
+                        //dS/du = Bu' T and dS/dv = Bu T'
+                        const float *dbu = &tableDU[a * nu];
+                        Pack ux = pset1(0.f), uy = pset1(0.f), uz = pset1(0.f);
+                        Pack vx = pset1(0.f), vy = pset1(0.f), vz = pset1(0.f);
+                        for (unsigned i = 0; i < nu; ++i) {
+                            Pack wu = pset1(bu[i]), dwu = pset1(dbu[i]);
+                            ux = padd(ux, pmul(ploada(&tx[i * stride + b]), dwu));
+                            uy = padd(uy, pmul(ploada(&ty[i * stride + b]), dwu));
+                            uz = padd(uz, pmul(ploada(&tz[i * stride + b]), dwu));
+                            vx = padd(vx, pmul(ploada(&dx[i * stride + b]), wu));
+                            vy = padd(vy, pmul(ploada(&dy[i * stride + b]), wu));
+                            vz = padd(vz, pmul(ploada(&dz[i * stride + b]), wu));
+                        }
+                        Pack nx = psub(pmul(vy, uz), pmul(vz, uy));
+                        Pack ny = psub(pmul(vz, ux), pmul(vx, uz));
+                        Pack nz = psub(pmul(vx, uy), pmul(vy, ux));
+                        unsigned count = std::min(lanes, b1 - b);
+                        normalize(nx, ny, nz, minNormal, (*normals)[a].data() + b, count);
+                        if (tangents)
+                            normalize(ux, uy, uz, minTangent, (*tangents)[a].data() + b, count);
+                    }
+                }
+            }
+        }
+    }
+
+    if (frames) {
+        repairFrames(*normals);
+        if (tangents)
+            repairFrames(*tangents);
     }
 }
 
@@ -171,45 +673,116 @@ void BezierSurface::CalculateSurfacePointsAnalytical(std::vector<std::vector<vec
  * @param stepV
  */
 void BezierSurface::OldCalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
-                                                        const float &stepV) {
+                                                        const float &stepV) const {
+    SamplingPlan planU = SamplingPlan::fromStep(stepU), planV = SamplingPlan::fromStep(stepV);
     surfacePts.clear();
-    for (float i = 0; i <= 1; i += stepU) {
+    for (unsigned a = 0; a < planU.size(); ++a) {
         surfacePts.emplace_back();
-        for (float j = 0; j <= 1; j += stepV) {
-            surfacePts.back().emplace_back(Analytical2D(i, j));
+        for (unsigned b = 0; b < planV.size(); ++b) {
+            surfacePts.back().emplace_back(Analytical2D(planU[a], planV[b]));
         }
     }
 }
 
+/**
+ * Tessellate the surface adaptively, see PatchTessellator, and append it to mesh
+ * @param mesh GL_TRIANGLES mesh
+ * @param epsilon Largest distance between the surface and its triangles
+ * @param maxTriangles Triangle budget
+ * @return
+ */
+PatchTessellationReport BezierSurface::CalculateSurfaceMeshAdaptive(Mesh &mesh, const float &epsilon,
+                                                                    const unsigned &maxTriangles) const {
+    return PatchTessellator(epsilon, maxTriangles).tessellate(nu, nv, ctrlPts, mesh);
+}
+
+/**
+ * Tessellate the surface adaptively with an error measured on the image of the camera, see PatchTessellator,
+ * and append it to mesh
+ * @param mesh GL_TRIANGLES mesh
+ * @param camera Its projection must have been set
+ * @param pixels Largest distance between the projections of the surface and of its triangles
+ * @param maxTriangles Triangle budget
+ * @return
+ */
+PatchTessellationReport BezierSurface::CalculateSurfaceMeshAdaptive(Mesh &mesh, const Orbiter &camera,
+                                                                    const float &pixels,
+                                                                    const unsigned &maxTriangles) const {
+    PatchTessellator tessellator(pixels, maxTriangles);
+    tessellator.setScreen(camera);
+    return tessellator.tessellate(nu, nv, ctrlPts, mesh);
+}
+
 /**
  * Make a surface
- * @param surfacePts Points of surface
+ * @param surfacePts Points of surface, rows of the same size
  * @return a surface
  */
-Mesh BezierSurface::genMesh(std::vector<std::vector<vec3>> &surfacePts) {
-    Mesh tmp(GL_TRIANGLES);
-    unsigned n = surfacePts.size();
-    for (int i = 0; i < n; ++i)
-        for (auto &pt: surfacePts[i])
-            tmp.vertex(pt);
-    for (int i = 0; i < n - 1; ++i)
-        for (int j = 0; j < surfacePts[i].size() - 1; ++j) {
-            tmp.triangle(i * n + j, i * n + j + 1, (i + 1) * n + j);
-            tmp.triangle((i + 1) * n + j, i * n + j + 1, (i + 1) * n + j + 1);
+Mesh BezierSurface::genMesh(const std::vector<std::vector<vec3>> &surfacePts) {
+    return gridMesh(surfacePts, nullptr);
+}
+
+/**
+ * Make a surface with a normal per vertex, as given by CalculateSurfaceFramesAnalytical
+ * @param surfacePts Points of surface, rows of the same size
+ * @param normals Same layout as surfacePts
+ * @return a surface
+ */
+Mesh BezierSurface::genMesh(const std::vector<std::vector<vec3>> &surfacePts,
+                            const std::vector<std::vector<vec3>> &normals) {
+    return gridMesh(surfacePts, &normals);
+}
+
+/**
+ * Mesh of a grid, vertex i * m + j for point j of row i, two triangles per cell. Positions, normals and indices
+ * are written into arrays of their final size, by rows spread over the OpenMP threads, then moved into the mesh
+ * @param surfacePts Rows of m points
+ * @param normals Same layout as surfacePts, or null
+ * @return
+ */
+Mesh BezierSurface::gridMesh(const std::vector<std::vector<vec3>> &surfacePts,
+                             const std::vector<std::vector<vec3>> *normals) {
+    int n = (int) surfacePts.size();
+    unsigned m = n > 0 ? surfacePts[0].size() : 0;
+    unsigned cells = n > 1 && m > 1 ? (n - 1) * (m - 1) : 0;
+    std::vector<vec3> positions(n * m);
+    std::vector<vec3> vertexNormals(normals ? n * m : 0);
+    std::vector<unsigned> indices(6 * cells);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        assert(surfacePts[i].size() == m);
+        std::copy(surfacePts[i].begin(), surfacePts[i].end(), positions.begin() + i * m);
+        if (normals)
+            std::copy((*normals)[i].begin(), (*normals)[i].end(), vertexNormals.begin() + i * m);
+        if (i + 1 == n || m < 2)
+            continue;
+        unsigned *out = &indices[6 * i * (m - 1)];
+        for (unsigned j = 0; j + 1 < m; ++j) {
+            unsigned a = i * m + j, b = a + 1, c = a + m, d = c + 1;
+            out[0] = a;
+            out[1] = b;
+            out[2] = c;
+            out[3] = c;
+            out[4] = b;
+            out[5] = d;
+            out += 6;
         }
+    }
+    Mesh tmp(GL_TRIANGLES);
+    tmp.vertices(std::move(positions), std::move(vertexNormals));
+    tmp.triangles(std::move(indices));
     return tmp;
 }
 
 /**
- * Get the bounding Box of the surface
+ * Get the bounding Box of the surface control points, which contains the surface
  * @param minPt
  * @param maxPt
  */
 void BezierSurface::getBounds(Point &minPt, Point &maxPt) const {
-    for (const std::vector<Point> &row: ctrlPts) {
-        for (const Point pt: row) {
-            minPt = min(minPt, pt);
-            maxPt = max(minPt, pt);
-        }
+    minPt = maxPt = ctrlPts.empty() ? Point(0, 0, 0) : ctrlPts[0];
+    for (const Point &pt: ctrlPts) {
+        minPt = min(minPt, pt);
+        maxPt = max(maxPt, pt);
     }
 }
\ No newline at end of file
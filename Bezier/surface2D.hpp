@@ -3,67 +3,141 @@
 #include "vec.h"
 #include "mat.h"
 #include "mesh.h"
+#include "aligned.hpp"
+#include "bernstein.hpp"
+#include "bezierN.hpp"
+#include "patchTessellator.hpp"
+#include "samplingPlan.hpp"
 #include <utility>
 #include <vector>
 
+/**
+ * Bezier patch of nu x nv control points, stored as a dense row-major grid : ctrlPts[i * nv + j] is the point j
+ * of row i, u runs across the rows and v along them.
+ * With setPlanar, the grid is also kept as three 32 bytes aligned coordinate planes, rows padded with zeros to a
+ * multiple of CurveBatch::LANES floats, which Analytical2D reads with aligned SIMD packs above bi-quintic nets.
+ * Only this single point path uses them : the grid tessellations broadcast one control point at a time against
+ * packs of basis values, which the row-major grid already serves.
+ */
 class BezierSurface {
 private:
-    std::vector<std::vector<Point>> ctrlPts;
-
-    //For analytical calculations
-    const float cnp[16][16] = {
-            {1, 0,  0,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 1,  0,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 2,  1,   0,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 3,  3,   1,   0,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 4,  6,   4,   1,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 5,  10,  5,   1,    0,    0,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 6,  15,  20,  15,   6,    1,    0,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 7,  21,  35,  35,   21,   7,    1,    0,    0,    0,    0,    0,   0,   0,  0},
-            {1, 8,  28,  56,  70,   56,   28,   8,    1,    0,    0,    0,    0,   0,   0,  0},
-            {1, 9,  36,  84,  126,  126,  84,   36,   9,    1,    0,    0,    0,   0,   0,  0},
-            {1, 10, 45,  120, 210,  252,  210,  120,  45,   10,   1,    0,    0,   0,   0,  0},
-            {1, 11, 55,  165, 330,  462,  462,  330,  165,  55,   11,   1,    0,   0,   0,  0},
-            {1, 12, 66,  220, 495,  792,  924,  792,  495,  220,  66,   12,   1,   0,   0,  0},
-            {1, 13, 78,  268, 715,  1287, 1716, 1716, 1287, 715,  286,  78,   13,  1,   0,  0},
-            {1, 14, 91,  364, 1001, 2002, 3003, 3432, 3003, 2002, 1001, 364,  91,  14,  1,  0},
-            {1, 15, 105, 455, 1365, 3003, 5005, 6435, 6435, 5005, 3003, 1365, 455, 105, 15, 1},
-    };
-
-    std::vector<float> ui;
-    std::vector<float> uni;
-    std::vector<float> vi;
-    std::vector<float> vni;
-
-    static vec3 Casteljau(const std::vector<Point> &pts, const float &u);
-
-    float Bu(const unsigned &i, const unsigned &n);
-
-    float Bv(const unsigned &i, const unsigned &n);
-
-    void initU(const float &u);
-
-    void initV(const float &v);
+    unsigned nu = 0;
+    unsigned nv = 0;
+    std::vector<Point> ctrlPts;
+
+    //Coordinate planes, planeX[i * planeStride + j] = ctrlPts[i * nv + j].x, only kept up to date while usePlanes is set
+    bool usePlanes = false;
+    unsigned planeStride = 0;
+    AlignedFloats planeX;
+    AlignedFloats planeY;
+    AlignedFloats planeZ;
+
+    //For analytical calculations, any degree : basis across the rows and along the rows
+    BernsteinBasis basisU;
+    BernsteinBasis basisV;
+
+    //Bernstein values at the parameters of the step tessellations, sampleBasisU[i * nbU + a] = Bu_i(u_a) and
+    //sampleBasisV[j * nbV + b] = Bv_j(v_b)
+    float sampleStepU = 0;
+    float sampleStepV = 0;
+    std::vector<float> sampleBasisU;
+    std::vector<float> sampleBasisV;
+
+    static Point Casteljau(Point *pts, const unsigned &n, const float &u);
+
+    static void sampleParams(std::vector<float> &params, const float &step);
+
+    static void flatten(const std::vector<std::vector<Point>> &net, unsigned &nu, unsigned &nv,
+                        std::vector<Point> &grid);
+
+    void initBases();
+
+    void updatePlanes();
+
+    void updateSampleBasis(const float &stepU, const float &stepV);
+
+    Point rowPoint(const unsigned &i, const float *wv) const;
+
+    PatchEvaluatorN specialized(const Point **rows) const;
+
+    static Mesh gridMesh(const std::vector<std::vector<vec3>> &surfacePts,
+                         const std::vector<std::vector<vec3>> *normals);
+
+    void gridProducts(std::vector<std::vector<vec3>> &surfacePts, std::vector<std::vector<vec3>> *normals,
+                      std::vector<std::vector<vec3>> *tangents, const SamplingPlan &planU,
+                      const SamplingPlan &planV) const;
 
 public:
-    explicit BezierSurface(std::vector<std::vector<Point>> ctrl);
+    explicit BezierSurface(const std::vector<std::vector<Point>> &ctrl);
+
+    BezierSurface(const unsigned &nu, const unsigned &nv, std::vector<Point> grid);
 
     void changeCtrlPts(const std::vector<std::vector<Point>> &newPts);
 
-    vec3 Analytical2D(const float &u, const float &v);
+    void changeCtrlPts(const unsigned &newNu, const unsigned &newNv, const std::vector<Point> &grid);
+
+    unsigned sizeU() const { return nu; }
+
+    unsigned sizeV() const { return nv; }
+
+    const std::vector<Point> &getCtrlPts() const { return ctrlPts; }
+
+    const Point &ctrlPt(const unsigned &i, const unsigned &j) const { return ctrlPts[i * nv + j]; }
+
+    void setPlanar(const bool &enable);
+
+    bool planar() const { return usePlanes; }
+
+    void moveCtrlPt(const unsigned &i, const unsigned &j, const Vector &delta);
+
+    void moveCtrlPt(const unsigned &i, const unsigned &j, const Vector &delta,
+                    std::vector<std::vector<vec3>> &surfacePts, const float &stepU, const float &stepV);
+
+    vec3 Analytical2D(const float &u, const float &v) const;
+
+    //Nets of up to STACK_SCRATCH rows plus points per row are evaluated by Casteljau2D with stack scratch, larger
+    //ones with a scratch per thread that only allocates when it grows
+    static const unsigned STACK_SCRATCH = 64;
+
+    unsigned casteljauScratchSize() const { return nu + nv; }
 
     vec3 Casteljau2D(const float &u, const float &v) const;
 
+    vec3 Casteljau2D(const float &u, const float &v, Point *scratch) const;
+
     void CalculateSurfacePointsCasteljau(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
                                          const float &stepV) const;
 
+    void CalculateSurfacePointsCasteljau(std::vector<std::vector<vec3>> &surfacePts, const SamplingPlan &planU,
+                                         const SamplingPlan &planV) const;
+
     void CalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
-                                          const float &stepV);
+                                          const float &stepV) const;
+
+    void CalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts, const SamplingPlan &planU,
+                                          const SamplingPlan &planV) const;
+
+    void CalculateSurfaceFramesAnalytical(std::vector<std::vector<vec3>> &surfacePts,
+                                          std::vector<std::vector<vec3>> &normals, const float &stepU,
+                                          const float &stepV, std::vector<std::vector<vec3>> *tangents = nullptr) const;
+
+    void CalculateSurfaceFramesAnalytical(std::vector<std::vector<vec3>> &surfacePts,
+                                          std::vector<std::vector<vec3>> &normals, const SamplingPlan &planU,
+                                          const SamplingPlan &planV,
+                                          std::vector<std::vector<vec3>> *tangents = nullptr) const;
 
     void OldCalculateSurfacePointsAnalytical(std::vector<std::vector<vec3>> &surfacePts, const float &stepU,
-                                             const float &stepV);
+                                             const float &stepV) const;
+
+    PatchTessellationReport CalculateSurfaceMeshAdaptive(Mesh &mesh, const float &epsilon,
+                                                         const unsigned &maxTriangles) const;
+
+    PatchTessellationReport CalculateSurfaceMeshAdaptive(Mesh &mesh, const Orbiter &camera, const float &pixels,
+                                                         const unsigned &maxTriangles) const;
+
+    static Mesh genMesh(const std::vector<std::vector<vec3>> &surfacePts);
 
-    static Mesh genMesh(std::vector<std::vector<vec3>> &surfacePts);
+    static Mesh genMesh(const std::vector<std::vector<vec3>> &surfacePts, const std::vector<std::vector<vec3>> &normals);
 
     void getBounds(Point &minPt, Point &maxPt) const;
 };
\ No newline at end of file
@@ -31,14 +31,15 @@ solution "gKit2light"
         buildoptions { "-std=c++11" }
         buildoptions { "-W -Wall -Wextra -Wsign-compare -Wno-unused-parameter -Wno-unused-function -Wno-unused-variable", "-pipe" }
         links { "GLEW", "SDL2", "SDL2_image", "GL" }
+        -- debug builds too, the bezier code has omp pragmas
+        buildoptions { "-fopenmp" }
+        linkoptions { "-fopenmp" }
     
     configuration { "linux", "debug" }
         buildoptions { "-g"}
         linkoptions { "-g"}
     
     configuration { "linux", "release" }
-        buildoptions { "-fopenmp" }
-        linkoptions { "-fopenmp" }
         buildoptions { "-flto"}
         linkoptions { "-flto"}
     
@@ -117,3 +118,15 @@ project("bezier")
     files { gkit_dir .. "/Bezier/*.cpp" }
     files { gkit_dir .. "/Bezier/*.hpp" }
 
+
+
+project("bezier_bench")
+	language "C++"
+	kind "ConsoleApp"
+	targetdir "bin"
+    files ( gkit_files )
+    files { gkit_dir .. "/Bezier/*.cpp" }
+    files { gkit_dir .. "/Bezier/*.hpp" }
+    excludes { gkit_dir .. "/Bezier/main.cpp" }
+    files { gkit_dir .. "/Bezier/bench/*.cpp" }
+    files { gkit_dir .. "/Bezier/bench/*.hpp" }
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <string>
 #include <algorithm>
+#include <utility>
 
 #include "vec.h"
 #include "mesh.h"
@@ -138,6 +139,82 @@ void Mesh::clear( )
     m_triangle_materials.clear();
 }
 
+// construction en bloc
+Mesh& Mesh::reserve( const unsigned int vertex_count, const unsigned int index_count )
+{
+    size_t n= m_positions.size() + vertex_count;
+    m_positions.reserve(n);
+    if(m_texcoords.size() > 0) m_texcoords.reserve(n);
+    if(m_normals.size() > 0) m_normals.reserve(n);
+    if(m_colors.size() > 0) m_colors.reserve(n);
+    m_indices.reserve(m_indices.size() + index_count);
+    return *this;
+}
+
+unsigned int Mesh::vertices( std::vector<vec3>&& positions, std::vector<vec3>&& normals )
+{
+    assert(normals.empty() || normals.size() == positions.size());
+    // les normales ne peuvent etre ajoutees qu'aux objets dont tous les sommets en ont deja une
+    assert(normals.empty() || m_normals.size() == m_positions.size());
+    assert(m_primitives != GL_LINE_STRIP && m_primitives != GL_LINE_LOOP && m_primitives != GL_TRIANGLE_STRIP && m_primitives != GL_TRIANGLE_FAN);
+    m_update_buffers= true;
+    
+    unsigned int first= m_positions.size();
+    size_t n= first + positions.size();
+    if(m_positions.empty())
+        m_positions= std::move(positions);
+    else
+        m_positions.insert(m_positions.end(), positions.begin(), positions.end());
+    
+    if(!normals.empty())
+    {
+        if(m_normals.empty())
+            m_normals= std::move(normals);
+        else
+            m_normals.insert(m_normals.end(), normals.begin(), normals.end());
+    }
+    
+    // copie les autres attributs des sommets, uniquement s'ils sont definis, comme vertex()
+    if(m_texcoords.size() > 0 && m_texcoords.size() < n)
+        m_texcoords.resize(n, m_texcoords.back());
+    if(m_normals.size() > 0 && m_normals.size() < n)
+        m_normals.resize(n, m_normals.back());
+    if(m_colors.size() > 0 && m_colors.size() < n)
+        m_colors.resize(n, m_colors.back());
+    
+    // copie la matiere courante, uniquement si elle est definie
+    if(m_triangle_materials.size() > 0 && size_t(triangle_count()) > m_triangle_materials.size())
+        m_triangle_materials.resize(triangle_count(), m_triangle_materials.back());
+    
+    return first;
+}
+
+Mesh& Mesh::triangles( std::vector<unsigned int>&& indices, const unsigned int first )
+{
+    assert(indices.size() % 3 == 0);
+    m_update_buffers= true;
+    
+    size_t n= m_indices.size();
+    if(m_indices.empty() && first == 0)
+        m_indices= std::move(indices);
+    else
+    {
+        m_indices.resize(n + indices.size());
+        for(size_t i= 0; i < indices.size(); i++)
+            m_indices[n + i]= first + indices[i];
+    }
+    
+#ifndef NDEBUG
+    for(size_t i= n; i < m_indices.size(); i++)
+        assert(m_indices[i] < m_positions.size());
+#endif
+    
+    // copie la matiere courante, uniquement si elle est definie
+    if(m_triangle_materials.size() > 0 && size_t(triangle_count()) > m_triangle_materials.size())
+        m_triangle_materials.resize(triangle_count(), m_triangle_materials.back());
+    return *this;
+}
+
 //
 Mesh& Mesh::triangle( const unsigned int a, const unsigned int b, const unsigned int c )
 {
@@ -159,6 +159,25 @@ public:
     void clear( );
     //@}
 
+    //! \name construction en bloc.
+    //@{
+    //! reserve la place de vertex_count sommets de plus (et de leurs attributs deja definis) et de index_count indices de plus.
+    Mesh& reserve( const unsigned int vertex_count, const unsigned int index_count );
+    /*! insere des sommets en bloc, avec leurs normales si normals n'est pas vide (une par position). renvoie l'indice du premier sommet insere.
+    les attributs deja definis par color(), texcoord() ou normal() sont recopies comme par vertex(). les tableaux sont deplaces dans l'objet s'il ne contient pas encore de sommets.
+    \code
+    Mesh m(GL_TRIANGLES);
+    std::vector<vec3> positions= { ... };
+    std::vector<unsigned int> indices= { ... };
+    unsigned int first= m.vertices(std::move(positions));
+    m.triangles(std::move(indices), first);
+    \endcode
+    */
+    unsigned int vertices( std::vector<vec3>&& positions, std::vector<vec3>&& normals= std::vector<vec3>() );
+    //! insere des triangles en bloc, 3 indices par triangle, decales de first. ne fonctionne pas avec les strips et les fans. le tableau est deplace dans l'objet s'il ne contient pas encore d'indices.
+    Mesh& triangles( std::vector<unsigned int>&& indices, const unsigned int first= 0 );
+    //@}
+
     //! \name description de triangles indexes.
     //@{
     /*! insere un triangle.  a, b, c sont les indices des sommets deja inseres dans l'objet. ne fonctionne pas avec les strips et les fans.